@@ -1,28 +1,18 @@
 #include <avr/io.h>
-// #include <util/delay.h>
+#include "gpio.h"
+#include "delay.h"
 
-static void delay_cycles(unsigned long cycles)
-{
-    while(cycles) {
-        __asm__ __volatile__ (
-            "nop\n\t"
-            "nop\n\t"
-            "nop"
-        );
-        cycles--;
-    }
-}
+#define LED_PIN B, 5    // PB5, digital pin 13 on Arduino Uno
 
 int main(void)
 {
     // Set pin 5 of PORTB (digital pin 13 on Arduino Uno) as output
-    DDRB |= (1 << DDB5);
+    gpio_output(LED_PIN);
 
     while (1) {
-        // Toggle LED
-        PORTB ^= (1 << PORTB5);
-        // _delay_ms(100);
-        delay_cycles(1600000);
+        // Toggle LED (one sbi on PINB)
+        gpio_toggle(LED_PIN);
+        delay_ms(1000);
     }
 
     return 0;
@@ -1,7 +1,34 @@
+#include <stdint.h>
+
 int main(void);
 
+/* Section boundaries from linker.ld */
+extern uint8_t __data_start[], __data_end[], __bss_start[], __bss_end[];
+extern const uint8_t __data_load_start[];
+
+/*
+ * Startup for the clang build (avr-gcc links avr-libc's crt instead).
+ * Runs on the reset stack (SP = RAMEND after reset), clears the zero
+ * register and SREG, copies .data from flash, zeroes .bss, then calls main.
+ */
 void reset_handler(void)
 {
+    __asm__ __volatile__ ("clr r1\n\tout 0x3f, r1");    /* r1 = 0, SREG = 0 */
+
+    const uint8_t *src = __data_load_start;
+    uint8_t *dst = __data_start;
+    while (dst != __data_end) {
+        uint8_t b;
+        /* .data's load image is in flash, which only lpm can read */
+        __asm__ __volatile__ ("lpm %0, Z+" : "=r" (b), "+z" (src));
+        *dst++ = b;
+    }
+
+    /* volatile stops the loop being turned into a memset() call; there is
+       no libc to provide one */
+    for (volatile uint8_t *p = __bss_start; p != __bss_end; )
+        *p++ = 0;
+
     main();
     for (;;);
 }
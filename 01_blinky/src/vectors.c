@@ -1,10 +1,43 @@
-#include <stdint.h>
+#include <avr/io.h>
 
-/* Forward declaration of reset handler */
-void reset_handler(void);
+/*
+ * Interrupt vector table for the clang build (avr-gcc links avr-libc's).
+ *
+ * Same layout as crt0.S in the later projects: the ATmega328P has 32K of
+ * flash, so every vector slot is two words (4 bytes) and holds a JMP. Slot
+ * 0 jumps to reset_handler (crt0.c) and slot n to __vector_n; each of those
+ * is a weak alias of __bad_interrupt until a C file defines the handler
+ * with ISR(<name>_vect), which emits a strong __vector_n. The slot count
+ * comes from _VECTORS_SIZE in the device header, so the table always
+ * matches it.
+ */
+#define STR_(x) #x
+#define STR(x)  STR_(x)
 
-/* AVR vector table symbol */
-__attribute__((section(".vectors")))
-void (*const __vectors[])(void) = {
-    reset_handler
-};
+__asm__ (
+    ".macro vector num\n"
+    "  .weak __vector_\\num\n"
+    "  .set __vector_\\num, __bad_interrupt\n"
+    "  jmp __vector_\\num\n"
+    ".endm\n"
+
+    ".pushsection .vectors, \"ax\", @progbits\n"
+    ".global __vectors\n"
+    "__vectors:\n"
+    "  jmp reset_handler\n"           /* Reset vector */
+    "  .altmacro\n"
+    "  .set vector_num, 1\n"
+    "  .rept (" STR(_VECTORS_SIZE) " / 4) - 1\n"
+    "  vector %vector_num\n"
+    "  .set vector_num, vector_num + 1\n"
+    "  .endr\n"
+    "  .noaltmacro\n"
+    ".popsection\n"
+
+    /* Unhandled interrupt: return and carry on */
+    ".pushsection .text\n"
+    ".global __bad_interrupt\n"
+    "__bad_interrupt:\n"
+    "  reti\n"
+    ".popsection\n"
+);
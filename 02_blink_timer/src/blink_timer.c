@@ -1,5 +1,8 @@
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include "gpio.h"
+
+#define LED_PIN B, 5    // PB5, digital pin 13
 
 // Function to initialize Timer1 in CTC mode for 500ms delay
 void timer1_init_500ms() {
@@ -31,14 +34,14 @@ void timer1_delay_500ms() {
 
 int main(void) {
     // Set pin 5 of PORTB (digital pin 13) as output
-    DDRB |= (1 << DDB5);
+    gpio_output(LED_PIN);
 
     // Initialize Timer1
     timer1_init_500ms();
 
     while (1) {
-        // Toggle LED
-        PORTB ^= (1 << PORTB5);
+        // Toggle LED (one sbi on PINB)
+        gpio_toggle(LED_PIN);
 
         // Delay using Timer1
         timer1_delay_500ms();
@@ -0,0 +1,84 @@
+#include "prng.h"
+#include <avr/io.h>
+
+// --- Seeding ---
+
+uint32_t prng_mix32(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x85EBCA6BUL;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35UL;
+    x ^= x >> 16;
+    return x;
+}
+
+// Internal temperature sensor against the 1.1 V reference. The ADC is
+// clocked at F_CPU / 4, far above its 200 kHz rating, so the low bits of
+// each result are dominated by noise rather than the actual temperature.
+#define SEED_ADMUX      ((1 << REFS1) | (1 << REFS0) | (1 << MUX3))
+#define SEED_ADCSRA     ((1 << ADEN) | (1 << ADPS1))
+#define SEED_SAMPLES    64
+
+uint32_t prng_seed_from_adc(void) {
+    uint8_t admux = ADMUX;
+    uint8_t adcsra = ADCSRA;
+    uint32_t seed = 0;
+
+    ADMUX = SEED_ADMUX;
+    ADCSRA = SEED_ADCSRA;
+
+    for (uint8_t i = 0; i < SEED_SAMPLES; i++) {
+        ADCSRA |= (1 << ADSC);
+        while (ADCSRA & (1 << ADSC));
+        // fold two noisy bits into the seed per conversion
+        seed = prng_rotl32(seed, 5) ^ (ADCW & 0x03);
+    }
+
+    ADCSRA = adcsra;
+    ADMUX = admux;
+    return prng_mix32(seed);
+}
+
+void prng16_seed(prng16_t *p, uint32_t seed) {
+    seed = prng_mix32(seed);
+    p->s = (uint16_t)(seed ^ (seed >> 16));
+    if (p->s == 0)
+        p->s = 0xACE1u;
+}
+
+void prng32_seed(prng32_t *p, uint32_t seed) {
+    p->s = prng_mix32(seed);
+    if (p->s == 0)
+        p->s = 0x2545F491UL;
+}
+
+void prng64_seed(prng64_t *p, uint32_t seed) {
+    p->s0 = prng_mix32(seed);
+    p->s1 = prng_mix32(seed ^ 0x9E3779B9UL);
+    if (p->s0 == 0 && p->s1 == 0)
+        p->s0 = 1;
+}
+
+// --- Integer ranges ---
+
+// Scale a 16-bit random value into [0, n): the high half of r * n. The low
+// half tells whether r fell into one of the (65536 % n) values that would
+// make some results more likely; those draws are rejected.
+#define PRNG_RANGE(next)                                    \
+    do {                                                    \
+        uint32_t m = (uint32_t)(next) * n;                  \
+        if ((uint16_t)m < n) {                              \
+            uint16_t threshold = (uint16_t)(0u - n) % n;    \
+            while ((uint16_t)m < threshold)                 \
+                m = (uint32_t)(next) * n;                   \
+        }                                                   \
+        return (uint16_t)(m >> 16);                         \
+    } while (0)
+
+uint16_t prng16_range(prng16_t *p, uint16_t n) {
+    PRNG_RANGE(prng16_next(p));
+}
+
+uint16_t prng32_range(prng32_t *p, uint16_t n) {
+    PRNG_RANGE(prng32_next(p) >> 16);
+}
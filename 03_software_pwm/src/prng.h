@@ -0,0 +1,95 @@
+#ifndef PRNG_H
+#define PRNG_H
+
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// Pseudo-random number generators
+// -----------------------------------------------------------------------------
+// prng16_t - xorshift16 (7, 9, 8), 2 bytes of state, period 2^16 - 1
+// prng32_t - xorshift32 (13, 17, 5), 4 bytes of state, period 2^32 - 1
+// prng64_t - xoroshiro64*, 8 bytes of state, period 2^64 - 1, 32-bit output
+//
+// All integer; nothing here touches float. The xorshift generators never
+// return 0 and must not be seeded with 0 (the seed functions take care of
+// that). Use the upper bits of the output where possible, they have the
+// best statistics.
+//
+// None of the generators are suitable for cryptography.
+
+typedef struct { uint16_t s; } prng16_t;
+typedef struct { uint32_t s; } prng32_t;
+typedef struct { uint32_t s0, s1; } prng64_t;
+
+// --- Seeding ---
+
+// Scramble a 32-bit value (MurmurHash3 finaliser). Turns a weak seed such
+// as a counter or a few noisy ADC bits into a well spread state.
+uint32_t prng_mix32(uint32_t x);
+
+// Gather a 32-bit seed from the noise in the LSBs of repeated ADC
+// conversions of the internal temperature sensor. Takes about 1 ms and
+// restores ADMUX/ADCSRA afterwards.
+uint32_t prng_seed_from_adc(void);
+
+void prng16_seed(prng16_t *p, uint32_t seed);
+void prng32_seed(prng32_t *p, uint32_t seed);
+void prng64_seed(prng64_t *p, uint32_t seed);
+
+// --- Generators (hot path, always inlined) ---
+
+static inline __attribute__((always_inline)) uint16_t prng16_next(prng16_t *p) {
+    uint16_t s = p->s;
+    s ^= s << 7;
+    s ^= s >> 9;
+    s ^= s << 8;
+    p->s = s;
+    return s;
+}
+
+static inline __attribute__((always_inline)) uint32_t prng32_next(prng32_t *p) {
+    uint32_t s = p->s;
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    p->s = s;
+    return s;
+}
+
+static inline uint32_t prng_rotl32(uint32_t x, uint8_t k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+static inline uint32_t prng64_next(prng64_t *p) {
+    uint32_t s0 = p->s0;
+    uint32_t s1 = p->s1;
+    uint32_t result = s0 * 0x9E3779BBUL;
+
+    s1 ^= s0;
+    p->s0 = prng_rotl32(s0, 26) ^ s1 ^ (s1 << 9);
+    p->s1 = prng_rotl32(s1, 13);
+    return result;
+}
+
+// --- Fixed-point output ---
+
+// Uniform fraction in [0, 1) as Q0.16 (0x0000 .. 0xFFFF / 65536).
+// prng16_unit never returns exactly 0, see above.
+static inline uint16_t prng16_unit(prng16_t *p) {
+    return prng16_next(p);
+}
+
+static inline uint16_t prng32_unit(prng32_t *p) {
+    return (uint16_t)(prng32_next(p) >> 16);
+}
+
+// --- Integer ranges ---
+
+// Uniform integer in [0, n) without modulo bias (multiply and reject,
+// D. Lemire). n must be non-zero. Rejection is rare: at most n / 65536 of
+// draws are retried. prng16_range inherits the generator's missing 0 and is
+// off by one part in 65535; use prng32_range where that matters.
+uint16_t prng16_range(prng16_t *p, uint16_t n);
+uint16_t prng32_range(prng32_t *p, uint16_t n);
+
+#endif // PRNG_H
@@ -13,10 +13,14 @@
  *
  * The timing uses Timer1 in CTC mode for accurate 20-microsecond delays.
  *
- * The brightness changes with a smooth sine-based curve,
- * representing inhale and exhale.
+ * The brightness follows a precomputed sine-based curve (inhale and
+ * exhale, gamma corrected) stored in flash by tools/gen_breath_table.py
+ * at build time.
+ * Playback uses a 32-bit phase accumulator and integer interpolation, so
+ * no floating point math runs on the per-frame path.
  *
- * Randomness is added via a simple pseudo-random generator
+ * Randomness is added via a 16-bit xorshift generator (prng.c),
+ * seeded from ADC noise at power-up so no two boards breathe alike,
  * to vary the breathing rate and brightness a bit
  * to make the effect look more natural.
  *
@@ -27,21 +31,28 @@
 
 #define F_CPU 16000000UL // Define CPU clock speed as 16 MHz
 
-#include <avr/interrupt.h> // Interrupt handling (not really used here)
-#include <avr/io.h>        // AVR device-specific IO definitions
-#include <math.h>          // Math functions like sin(), powf()
+#include <avr/io.h>          // AVR device-specific IO definitions
+#include <avr/pgmspace.h>    // pgm_read_byte() for the flash curve table
+#include <stdint.h>
+#include "breath_table.h"    // Generated: breath_table[], BREATH_TABLE_MID
+#include "prng.h"            // xorshift generators, ADC noise seeding
+#include "gpio.h"            // gpio_set()/gpio_clear(): single sbi/cbi
 
-// Define the PWM pin and its associated port and direction register
-#define PWM_PIN PB5 // Pin 5 on Port B (Arduino Uno digital pin 13)
-#define PWM_PORT PORTB
-#define PWM_DDR DDRB
+// Define the PWM pin as port and bit (see gpio.h)
+#define PWM_PIN B, 5 // Pin 5 on Port B (Arduino Uno digital pin 13)
 
 // Breathing frequency in Hz (~0.16667 Hz means one breath every 6 seconds)
 #define BREATH_FREQUENCY 0.16667f
 
+// Time covered by one PWM frame (255 steps of 20 us, rounded to 5 ms)
+#define BREATH_STEP_SECONDS 0.005f
+
+// Phase advance per frame; a full breath is 2^32. Folded at compile time.
+#define BREATH_PHASE_INC ((uint32_t)(4294967296.0f * BREATH_STEP_SECONDS * BREATH_FREQUENCY))
+
 // Initialize PWM pin as output
 void pwm_pin_init() {
-    PWM_DDR |= (1 << PWM_PIN); // Set PWM_PIN bit in DDRB to 1 => output
+    gpio_output(PWM_PIN); // Set PWM_PIN bit in DDRB to 1 => output
 }
 
 // Initialize Timer1 to create a delay of approximately 20 microseconds
@@ -68,84 +79,101 @@ void timer1_delay_20us() {
         ; // Wait until compare match occurs
 }
 
-// Generate a pseudo-random float between 0 and 1 using a simple XOR shift
-// algorithm
-static float rand_float() {
-    static uint16_t seed = 0xACE1u; // Static seed value, retains value between calls
-    seed ^= seed << 7;              // XOR shift operations to generate new seed
-    seed ^= seed >> 9;
-    seed ^= seed << 8;
-    // Normalize the 16-bit result to float between 0 and 1
-    return (float)(seed & 0xFFFF) / 65535.0f;
+// Random source for the breathing noise, seeded from ADC noise in main()
+static prng16_t rng;
+
+// Pseudo-random byte from the 16-bit xorshift generator
+static uint8_t rand_u8() {
+    return (uint8_t)(prng16_next(&rng) >> 8); // Upper byte has the best statistics
 }
 
-// Smooth random function to produce a value gradually changing over time
-// 'prev' is the previous value, 'alpha' controls how fast the value changes
-float smooth_rand(float prev, float alpha) {
-    // Move previous value a bit closer to a new random value
-    return prev + alpha * (rand_float() - prev);
+// Smooth random value (0-255) gradually changing over time
+// 'prev' is the previous value, 'shift' controls how fast the value changes
+// (new = prev + (rand - prev) / 2^shift)
+static uint8_t smooth_rand(uint8_t prev, uint8_t shift) {
+    int16_t delta = (int16_t)rand_u8() - prev;
+    return (uint8_t)(prev + (delta >> shift));
 }
 
 #define MAX_BRIGHTNESS_BASE 0.100f // Base max brightness (scaled to duty cycle)
 #define MIN_BRIGHTNESS_BASE 0.005f // Base min brightness
 
-// Calculate the PWM duty cycle (0-255) based on a "breathing" pattern at time
-// 't' rand_state1, rand_state2, rand_state3 hold smooth random states to vary
-// the breath
-uint8_t get_breath_duty(float t, float *rand_state1, float *rand_state2, float *rand_state3) {
-    // Calculate base breath period from frequency (seconds per breath cycle)
-    float breath_period_base = 1.0f / BREATH_FREQUENCY;
-
-    // Introduce a slight random variation to the breath period (~±5%)
-    float breath_period = breath_period_base * (0.95f + 0.05f * smooth_rand(*rand_state1, 0.01f));
-    *rand_state1 = breath_period; // Update rand_state1 with new breath_period value
-
-    float half_period = breath_period / 2.0f;
-
-    // For initial time less than breath period, turn LED off (duty = 0)
-    if (t < breath_period)
-        return 0;
-
-    // Time within current breath cycle, modulo breath period to wrap time
-    float adjusted_t = t - breath_period;
-    float inhale_duration = 0.7f * half_period; // Inhale takes 70% of half period
-    float exhale_duration = breath_period - inhale_duration;
-
-    // Phase time cycles between 0 and breath_period
-    float phase_time = fmod(adjusted_t, breath_period);
-
-    // Slight random variation in max brightness (~±10%)
-    float max_brightness = MAX_BRIGHTNESS_BASE * (0.9f + 0.1f * smooth_rand(*rand_state2, 0.02f));
-    *rand_state2 = max_brightness;
-
-    // Slight random variation in min brightness (~±10%)
-    float min_brightness = MIN_BRIGHTNESS_BASE * (0.8f + 0.1f * smooth_rand(*rand_state3, 0.02f));
-    *rand_state3 = min_brightness;
-
-    float breath; // Will hold the normalized brightness value
-
-    if (phase_time < inhale_duration) {
-        // Inhale phase: brightness rises smoothly with a sine curve
-        float p = phase_time / inhale_duration; // Progress from 0 to 1 during inhale
-        float s = sin(M_PI * p);                // Sinusoidal easing from 0 to 1
-        breath = powf(s, 2.0f);                 // Square to smooth curve more
-        breath *= (0.95f + 0.1f * smooth_rand(*rand_state3, 0.05f)); // Slight randomness
-    } else {
-        // Exhale phase: brightness decreases smoothly, inverted sine curve
-        float p = (phase_time - inhale_duration) / exhale_duration;
-        float s = sin(M_PI * p + M_PI); // Sine wave shifted by PI (starts at 0, ends at 0)
-        breath = -powf(-s, 3.0f);       // Cubic easing for a smoother curve
-        breath *= (0.95f + 0.1f * smooth_rand(*rand_state3, 0.05f));
-    }
+// Brightness fraction as an 8.8 fixed-point duty cycle (0.0-1.0 => 0-255.0)
+#define BRIGHTNESS_Q8(x) ((uint16_t)((x) * 255.0f * 256.0f + 0.5f))
+
+// Breath playback state
+typedef struct {
+    uint32_t phase;     // Position within the current breath (2^32 = one breath)
+    uint32_t phase_inc; // Phase advance per PWM frame (jittered every breath)
+    uint16_t max_q8;    // Max duty of the current breath, 8.8 fixed point
+    uint16_t min_q8;    // Min duty of the current breath, 8.8 fixed point
+    uint8_t rate_noise; // Smooth random states (0-255, 128 = nominal)
+    uint8_t level_noise;
+    uint8_t amp_noise;
+    uint8_t warmup;     // LED stays off for the first breath
+} breath_t;
+
+// Pick new per-breath variations (called once per breath, not per frame)
+static void breath_new_cycle(breath_t *b) {
+    // Slight random variation to the breath period (~±5%)
+    b->rate_noise = smooth_rand(b->rate_noise, 2);
+    int8_t jitter = (int8_t)(((uint16_t)b->rate_noise * 26) >> 8) - 13;
+    b->phase_inc = (uint32_t)BREATH_PHASE_INC + (int32_t)(BREATH_PHASE_INC >> 8) * jitter;
+
+    // Slight random variation in max (0.9-1.0) and min (0.8-0.9) brightness
+    b->level_noise = smooth_rand(b->level_noise, 2);
+    uint8_t spread = ((uint16_t)b->level_noise * 26) >> 8;
+    b->max_q8 = ((uint32_t)BRIGHTNESS_Q8(MAX_BRIGHTNESS_BASE) * (230 + spread)) >> 8;
+    b->min_q8 = ((uint32_t)BRIGHTNESS_Q8(MIN_BRIGHTNESS_BASE) * (204 + spread)) >> 8;
+}
 
-    // Map breath from [-1, 1] to [0, 1]
-    breath = (breath + 1.0f) / 2.0f;
+// Initialise breath playback at the start of the off period
+void breath_init(breath_t *b) {
+    b->phase = 0;
+    b->rate_noise = 128;
+    b->level_noise = 128;
+    b->amp_noise = 128;
+    b->warmup = 1;
+    breath_new_cycle(b);
+}
 
-    // Scale breath to between min and max brightness
-    breath = breath * (max_brightness - min_brightness) + min_brightness;
+// Calculate the PWM duty cycle (0-255) for the current frame and advance
+// the breath by one frame. Only integer math and one flash table lookup.
+uint8_t get_breath_duty(breath_t *b) {
+    uint16_t pos = (uint16_t)(b->phase >> 16); // Top 16 bits index the curve
+    uint8_t duty = 0;
+
+    if (!b->warmup) {
+        // Linear interpolation between two neighbouring table entries
+        uint8_t index = pos >> 8;
+        uint8_t frac = pos & 0xFF;
+        int16_t a = pgm_read_byte(&breath_table[index]);
+        int16_t c = pgm_read_byte(&breath_table[index + 1]);
+        int16_t level = a + (((c - a) * frac) >> 8);
+
+        // Slight randomness on the breath depth (0.95-1.05 around rest level)
+        b->amp_noise = smooth_rand(b->amp_noise, 4);
+        uint16_t amp = 243 + (((uint16_t)b->amp_noise * 26) >> 8);
+        level = BREATH_TABLE_MID + (((int32_t)(level - BREATH_TABLE_MID) * amp) >> 8);
+        if (level < 0)
+            level = 0;
+        else if (level > 255)
+            level = 255;
+
+        // Scale level to between min and max brightness
+        uint16_t span = b->max_q8 - b->min_q8;
+        duty = (b->min_q8 + (((uint32_t)level * span) >> 8)) >> 8;
+    }
+
+    // Advance phase; a wrap means the next breath starts
+    uint32_t next = b->phase + b->phase_inc;
+    if (next < b->phase) {
+        b->warmup = 0;
+        breath_new_cycle(b);
+    }
+    b->phase = next;
 
-    // Convert brightness (0.0-1.0) to PWM duty cycle (0-255)
-    return (uint8_t)(breath * 255.0f);
+    return duty;
 }
 
 // Software PWM routine: generates PWM by turning pin on/off manually
@@ -154,9 +182,9 @@ void software_pwm(uint8_t duty) {
     // Loop 255 times for 8-bit resolution PWM
     for (uint8_t i = 0; i < 255; i++) {
         if (i < duty)
-            PWM_PORT |= (1 << PWM_PIN); // Turn pin HIGH (LED on)
+            gpio_set(PWM_PIN); // Turn pin HIGH (LED on)
         else
-            PWM_PORT &= ~(1 << PWM_PIN); // Turn pin LOW (LED off)
+            gpio_clear(PWM_PIN); // Turn pin LOW (LED off)
 
         timer1_delay_20us(); // Wait ~20 microseconds per step
     }
@@ -166,21 +194,16 @@ void software_pwm(uint8_t duty) {
 int main(void) {
     pwm_pin_init();     // Setup PWM pin as output
     timer1_init_20us(); // Initialize timer for delays
+    prng16_seed(&rng, prng_seed_from_adc());
 
-    float time = 0.0f;              // Elapsed time in seconds (simulated)
-    const float time_step = 0.005f; // Time step increment per PWM cycle (5 ms)
-
-    // States for smooth random generators
-    float rand_state1 = 0.0f, rand_state2 = 0.0f, rand_state3 = 0.0f;
+    breath_t breath;    // Breath phase, brightness range and noise states
+    breath_init(&breath);
 
     while (1) {
-        // Calculate PWM duty cycle for the current time
-        uint8_t duty = get_breath_duty(time, &rand_state1, &rand_state2, &rand_state3);
+        // Calculate PWM duty cycle for the current frame
+        uint8_t duty = get_breath_duty(&breath);
 
         // Output PWM signal with calculated duty cycle (software PWM)
         software_pwm(duty);
-
-        // Increment time by time_step seconds
-        time += time_step;
     }
 }
@@ -0,0 +1,242 @@
+#!/usr/bin/env python3
+"""
+gen_breath_table.py
+
+Generates the PROGMEM breathing curve used by software_pwm.c.
+
+The table holds one complete breath (inhale followed by exhale) sampled at
+BREATH_TABLE_SIZE points. Each entry is the normalised brightness level
+(0..255) after the sine easing of the original float implementation:
+
+    inhale (first 35% of the cycle):  sin(pi * p) ^ 2
+    exhale (remaining 65%):          -sin(pi * p) ^ 3
+
+mapped from [-1, 1] to [0, 1] and raised to the power gamma. The eye sees
+LED duty roughly as its 1/2.2 power, so the default gamma of 2.2 makes
+the brightness, rather than the duty, follow the sine easing: the breath
+lingers near the dim end instead of seeming to snap off. --gamma 1
+reproduces the original curve. BREATH_TABLE_MID is the resting level
+(breath value 0) after the gamma, around which the firmware scales the
+breath depth. One extra entry (a copy of the first) is appended so the
+firmware can interpolate between entry i and i + 1 without wrapping the
+index.
+
+Usage:
+    python3 gen_breath_table.py --out build/breath_table.h
+    python3 gen_breath_table.py --compare [--gamma 1.0] [--cc clang]
+
+--compare compiles the playback in src/software_pwm.c for the host (AVR
+registers, GPIO and the noise generator replaced by stubs, noise held at
+its mean), runs it for one breath next to the original float curve with
+the same gamma, and prints the duty-cycle error, so any change to the
+table or the playback maths can be checked on the host before flashing.
+"""
+
+import argparse
+import ctypes
+import math
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+TABLE_SIZE = 256          # entries per breath (index = phase >> 8)
+INHALE_FRACTION = 0.35    # 0.7 * half period, as in the original code
+DEFAULT_GAMMA = 2.2       # perceptual correction, see above
+
+# Brightness range of the original float code, as in software_pwm.c
+MAX_BRIGHTNESS_BASE = 0.100
+MIN_BRIGHTNESS_BASE = 0.005
+
+
+def breath_shape(p):
+    """Normalised breath value in [-1, 1] at cycle position p in [0, 1)."""
+    if p < INHALE_FRACTION:
+        s = math.sin(math.pi * (p / INHALE_FRACTION))
+        return s * s
+    s = math.sin(math.pi * ((p - INHALE_FRACTION) / (1.0 - INHALE_FRACTION)))
+    return -(s * s * s)
+
+
+def quantise(level):
+    return min(255, max(0, int(round(level * 255.0))))
+
+
+def build_table(gamma):
+    table = []
+    for i in range(TABLE_SIZE):
+        level = (breath_shape(i / TABLE_SIZE) + 1.0) / 2.0
+        table.append(quantise(level ** gamma))
+    table.append(table[0])
+    return table
+
+
+def resting_level(gamma):
+    return quantise(0.5 ** gamma)
+
+
+def write_header(path, table, gamma):
+    rows = []
+    for i in range(0, len(table), 16):
+        rows.append("    " + ", ".join("%3d" % v for v in table[i:i + 16]) + ",")
+
+    text = []
+    text.append("/* breath_table.h - generated by tools/gen_breath_table.py, do not edit */")
+    text.append("")
+    text.append("#ifndef BREATH_TABLE_H")
+    text.append("#define BREATH_TABLE_H")
+    text.append("")
+    text.append("#include <avr/pgmspace.h>")
+    text.append("#include <stdint.h>")
+    text.append("")
+    text.append("#define BREATH_TABLE_SIZE %d" % TABLE_SIZE)
+    text.append("#define BREATH_TABLE_MID %d" % resting_level(gamma))
+    text.append("#define BREATH_TABLE_GAMMA %.3ff" % gamma)
+    text.append("")
+    text.append("// One breath: inhale (%d%%) then exhale, plus a wrap entry for interpolation"
+                % int(INHALE_FRACTION * 100))
+    text.append("static const uint8_t breath_table[BREATH_TABLE_SIZE + 1] PROGMEM = {")
+    text.extend(rows)
+    text.append("};")
+    text.append("")
+    text.append("#endif // BREATH_TABLE_H")
+    text.append("")
+
+    with open(path, "w", newline="\n") as f:
+        f.write("\n".join(text))
+
+
+def float_duty(p, gamma):
+    """Original get_breath_duty() with every smooth_rand() at its mean (0.5),
+    plus the gamma applied to the normalised breath as in the table."""
+    max_brightness = MAX_BRIGHTNESS_BASE * (0.9 + 0.1 * 0.5)
+    min_brightness = MIN_BRIGHTNESS_BASE * (0.8 + 0.1 * 0.5)
+    breath = breath_shape(p) * (0.95 + 0.1 * 0.5)
+    breath = ((breath + 1.0) / 2.0) ** gamma
+    breath = breath * (max_brightness - min_brightness) + min_brightness
+    return int(breath * 255.0)
+
+
+# --- Host build of the firmware playback ---
+
+# Stand-ins for the AVR headers software_pwm.c includes. prng16_next()
+# always returns 0x8000, so every smooth_rand() state stays at its mean.
+HOST_SHIMS = {
+    "avr/io.h": """\
+#include <stdint.h>
+static volatile uint8_t DDRB, PORTB, PINB, TCCR1A, TCCR1B, TIFR1;
+static volatile uint16_t TCNT1, OCR1A;
+#define WGM12 3
+#define CS10  0
+#define OCF1A 1
+""",
+    "avr/pgmspace.h": """\
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+""",
+    "gpio.h": """\
+#define gpio_output(pin) ((void)0)
+#define gpio_set(pin)    ((void)0)
+#define gpio_clear(pin)  ((void)0)
+""",
+    "prng.h": """\
+#include <stdint.h>
+typedef struct { uint16_t s; } prng16_t;
+static inline uint32_t prng_seed_from_adc(void) { return 0; }
+static inline void prng16_seed(prng16_t *p, uint32_t seed) { p->s = (uint16_t)seed; }
+static inline uint16_t prng16_next(prng16_t *p) { (void)p; return 0x8000; }
+""",
+}
+
+
+class Breath(ctypes.Structure):
+    """breath_t in software_pwm.c"""
+    _fields_ = [("phase", ctypes.c_uint32), ("phase_inc", ctypes.c_uint32),
+                ("max_q8", ctypes.c_uint16), ("min_q8", ctypes.c_uint16),
+                ("rate_noise", ctypes.c_uint8), ("level_noise", ctypes.c_uint8),
+                ("amp_noise", ctypes.c_uint8), ("warmup", ctypes.c_uint8)]
+
+
+def build_playback(cc, workdir, table, gamma):
+    # software_pwm.c is copied next to the stubs so its "gpio.h" and
+    # "prng.h" includes find them before the AVR versions in src/
+    os.makedirs(os.path.join(workdir, "avr"))
+    for name, text in HOST_SHIMS.items():
+        with open(os.path.join(workdir, name), "w") as f:
+            f.write(text)
+    write_header(os.path.join(workdir, "breath_table.h"), table, gamma)
+    src = os.path.join(workdir, "software_pwm.c")
+    shutil.copy(os.path.join(ROOT, "src", "software_pwm.c"), src)
+
+    lib = os.path.join(workdir, "software_pwm.so")
+    subprocess.check_call([cc, "-O2", "-shared", "-fPIC", "-I" + workdir, src, "-o", lib])
+    dll = ctypes.CDLL(lib)
+    dll.breath_init.restype = None
+    dll.breath_init.argtypes = [ctypes.POINTER(Breath)]
+    dll.get_breath_duty.restype = ctypes.c_uint8
+    dll.get_breath_duty.argtypes = [ctypes.POINTER(Breath)]
+    return dll
+
+
+def compare(table, gamma, cc):
+    with tempfile.TemporaryDirectory() as workdir:
+        dll = build_playback(cc, workdir, table, gamma)
+        b = Breath()
+        dll.breath_init(ctypes.byref(b))
+
+        # the first breath is the warm-up with the LED off
+        while True:
+            phase = b.phase
+            dll.get_breath_duty(ctypes.byref(b))
+            if b.phase < phase:
+                break
+
+        steps = 0
+        worst = 0
+        total = 0
+        while True:
+            phase = b.phase
+            new = dll.get_breath_duty(ctypes.byref(b))
+            old = float_duty(phase / 4294967296.0, gamma)
+            err = abs(new - old)
+            worst = max(worst, err)
+            total += err
+            steps += 1
+            if b.phase < phase:
+                break
+
+    print("gamma            : %.2f" % gamma)
+    print("steps per breath : %d" % steps)
+    print("max |duty error| : %d" % worst)
+    print("mean |duty error|: %.3f" % (total / steps))
+    return worst
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate the breathing LED curve table")
+    parser.add_argument("--out", help="header file to write")
+    parser.add_argument("--gamma", type=float, default=DEFAULT_GAMMA,
+                        help="extra perceptual gamma applied to the curve (default %(default)s)")
+    parser.add_argument("--compare", action="store_true",
+                        help="compare the float and fixed-point curves on the host")
+    parser.add_argument("--cc", default=os.environ.get("CC", "cc"),
+                        help="host C compiler for --compare")
+    args = parser.parse_args()
+
+    table = build_table(args.gamma)
+
+    if args.out:
+        write_header(args.out, table, args.gamma)
+    if args.compare:
+        # the firmware duty range is only a few dozen steps, allow one LSB
+        return 0 if compare(table, args.gamma, args.cc) <= 1 else 1
+    if not args.out:
+        parser.print_help()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,73 @@
+#ifndef GPIO_H
+#define GPIO_H
+
+#include "avr/io.h"
+
+// -----------------------------------------------------------------------------
+// Compile-time GPIO pins
+// -----------------------------------------------------------------------------
+// A pin is a port letter and a bit number, usually given a name once:
+//
+//   #define LED_PIN B, 5              // PB5, Arduino digital pin 13
+//
+//   gpio_output(LED_PIN);
+//   gpio_set(LED_PIN);
+//   gpio_toggle(LED_PIN);
+//   if (gpio_read(BUTTON_PIN)) ...
+//
+// Port and bit are constants, so every single-pin operation is exactly one
+// instruction: sbi/cbi on PORTx or DDRx (2 cycles), and the toggle is an sbi
+// on PINx - writing a 1 to PINx flips the output latch in hardware. None of
+// them read-modify-write the whole port, so they are safe against interrupts
+// that touch other pins of the same port.
+//
+// Compare "PORTB ^= (1 << PB5)", which is in/eor/out: three instructions
+// and a window where an ISR changing another PORTB pin gets overwritten.
+//
+// The inline assembly makes the instruction choice independent of the
+// optimisation level and of the compiler (avr-gcc or clang).
+
+// Pin argument helpers: gpio_x(LED_PIN) -> _gpio_x(B, 5)
+#define gpio_output(pin)    _gpio_sbi(DDR, pin)
+#define gpio_input(pin)     _gpio_cbi(DDR, pin)
+#define gpio_set(pin)       _gpio_sbi(PORT, pin)
+#define gpio_clear(pin)     _gpio_cbi(PORT, pin)
+#define gpio_toggle(pin)    _gpio_sbi(PIN, pin)
+#define gpio_pullup(pin)    _gpio_sbi(PORT, pin)    // input + PORTx bit = pull-up
+#define gpio_read(pin)      _gpio_read(pin)
+#define gpio_write(...)     _gpio_write(__VA_ARGS__)   // gpio_write(pin, value)
+
+#define _gpio_sbi(reg, ...) _gpio_sbi_(reg, __VA_ARGS__)
+#define _gpio_cbi(reg, ...) _gpio_cbi_(reg, __VA_ARGS__)
+
+#define _gpio_sbi_(reg, port, bit) \
+    __asm__ __volatile__ ("sbi %0, %1" :: "I" (_SFR_IO_ADDR(reg ## port)), "I" (bit))
+#define _gpio_cbi_(reg, port, bit) \
+    __asm__ __volatile__ ("cbi %0, %1" :: "I" (_SFR_IO_ADDR(reg ## port)), "I" (bit))
+
+#define _gpio_write(port, bit, v) \
+    do { if (v) _gpio_sbi_(PORT, port, bit); else _gpio_cbi_(PORT, port, bit); } while (0)
+
+#define _gpio_read(...) _gpio_read_(__VA_ARGS__)
+#define _gpio_read_(port, bit) ((PIN ## port & (1 << (bit))) != 0)
+
+// -----------------------------------------------------------------------------
+// Multi-pin masked write
+// -----------------------------------------------------------------------------
+// Set the pins selected by 'mask' on one port to the matching bits of
+// 'value' and leave the others alone:
+//
+//   gpio_write_mask(D, 0xF0, nibble << 4);
+//
+// Works through PINx: the bits that differ from the wanted state are
+// toggled with a single out, so all pins in the mask change on the same
+// cycle, and pins outside the mask are never written (an ISR changing them
+// between the read and the write is not undone).
+// in + eor + andi + out = 4 cycles; with a constant value the compiler
+// folds it further.
+#define gpio_write_mask(port, mask, value)                          \
+    do {                                                            \
+        PIN ## port = (uint8_t)((PORT ## port ^ (value)) & (mask)); \
+    } while (0)
+
+#endif // GPIO_H
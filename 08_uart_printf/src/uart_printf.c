@@ -97,7 +97,7 @@ void uart_print_oct_width(unsigned long n, int width, char pad, bool alt) {
 
 void uart_print_ptr(void *ptr) {
     unsigned int addr = (unsigned int)ptr;
-    uart_puts("0x");
+    uart_puts(PSTR("0x"));
     uart_print_hex_width(addr, 0, '0', false);
 }
 
@@ -212,7 +212,11 @@ void uart_printf(const char *fmt, ...) {
 
             switch (c) {
                 case 'c': uart_putc((char)va_arg(args, int)); break;
-                case 's': uart_puts(va_arg(args, const char*)); break;
+                case 's': {
+                    const char *str = va_arg(args, const char*);   // RAM string
+                    while (*str) uart_putc(*str++);
+                    break;
+                }
                 case 'd': {
                     long val = long_flag ? va_arg(args, long) : va_arg(args, int);
                     if (val < 0) { uart_putc('-'); uart_print_ulong_width((unsigned long)(-val), width, pad, false, false); }
@@ -268,16 +272,16 @@ int main(void) {
     uart_init();
 
     // --- Test Cases ---
-    uart_printf("Char: %c, String: %s\n", 'A', "Hello World");
-    uart_printf("Int: %+05d, UInt: %u\n", -123, 456);
+    uart_printf(PSTR("Char: %c, String: %s\n"), 'A', "Hello World");
+    uart_printf(PSTR("Int: %+05d, UInt: %u\n"), -123, 456);
     long big_num = 2147483648L;
-    uart_printf("Long: %ld\n", big_num);
+    uart_printf(PSTR("Long: %ld\n"), big_num);
     int val = 255;
-    uart_printf("Hex: %#x, Octal: %#o, Pointer: %p\n", val, val, &val);
+    uart_printf(PSTR("Hex: %#x, Octal: %#o, Pointer: %p\n"), val, val, &val);
 
     double pi = 3.14159265;
     double small = 0.0001234;
-    uart_printf("Float: %.4f, Sci: %.3e\n", pi, small);
+    uart_printf(PSTR("Float: %.4f, Sci: %.3e\n"), pi, small);
 
     while (1) { }
     return 0;
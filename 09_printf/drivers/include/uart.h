@@ -4,8 +4,10 @@
 #include "avr/io.h"
 #include "config.h"
 
-#define BAUD 57600
-#define UBRR_VALUE ((F_CPU / (16UL * BAUD)) - 1)
+#ifndef BAUD
+#define BAUD 57600UL
+#endif
+#include "avr/baud.h"               // UBRR_VALUE, USE_U2X
 
 void uart_init(void);
 
@@ -8,6 +8,11 @@
 void uart_init(void) {
     UBRR0H = (uint8_t)(UBRR_VALUE >> 8);
     UBRR0L = (uint8_t)(UBRR_VALUE & 0xFF);
+#if USE_U2X
+    UCSR0A = (1 << U2X0);                   // double speed, 8 samples per bit
+#else
+    UCSR0A = 0;
+#endif
     UCSR0B = (1 << TXEN0); // Enable TX only
     UCSR0C = (1 << UCSZ01) | (1 << UCSZ00); // 8N1
 }
@@ -94,7 +99,7 @@ void uart_print_oct_width(unsigned long n, int width, char pad, bool alt) {
 
 void uart_print_ptr(void *ptr) {
     unsigned int addr = (unsigned int)ptr;
-    uart_puts("0x");
+    uart_puts(PSTR("0x"));
     uart_print_hex_width(addr, 0, '0', false);
 }
 
@@ -209,7 +214,11 @@ void printf(const char *fmt, ...) {
 
             switch (c) {
                 case 'c': uart_putc((char)va_arg(args, int)); break;
-                case 's': uart_puts(va_arg(args, const char*)); break;
+                case 's': {
+                    const char *str = va_arg(args, const char*);   // RAM string
+                    while (*str) uart_putc(*str++);
+                    break;
+                }
                 case 'd': {
                     long val = long_flag ? va_arg(args, long) : va_arg(args, int);
                     if (val < 0) { uart_putc('-'); uart_print_ulong_width((unsigned long)(-val), width, pad, false, false); }
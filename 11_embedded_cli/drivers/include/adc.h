@@ -0,0 +1,120 @@
+#ifndef ADC_H
+#define ADC_H
+
+#include "avr/io.h"
+#include "stdint.h"
+#include "stdbool.h"
+
+// Free-running ADC sampling a set of channels in turn from the conversion
+// complete interrupt. A conversion takes 13 ADC clocks (104 us at clk/128),
+// so waiting for one from the CLI would hold the main loop up each time;
+// here reading a channel only copies its latest results.
+//
+// For each channel the interrupt sums 4^n conversions (oversampling) and
+// scales the sum down by 2^n, which gives n extra bits of resolution when
+// the input carries some noise (at least 1 LSB). Each of these decimated
+// results also updates a moving average over the last ADC_AVG_LEN results
+// and an exponential average (weight 1 / 2^ADC_EMA_SHIFT).
+//
+// Channels are switched in the interrupt while the next conversion is
+// already running (the multiplexer is latched at its start), so no
+// conversion is lost. Sources above 10k need a buffer or a capacitor.
+//
+//   adc_start(0x03, 2);           // A0 and A1, 16x oversampling, 12 bits
+//   ...
+//   adc_result_t r;
+//   if (adc_read(0, &r)) ... r.value, r.average, r.ema
+//
+// Scan mode instead converts a list of channels once per period, as one
+// frame: the Timer0 compare match of the 1 ms tick triggers the first
+// conversion and the interrupt starts each following one, so a frame
+// spans at most ADC_SCAN_MAX * 108 us from its timestamp. Ticks between
+// frames still trigger a conversion, which the interrupt drops.
+//
+// Frames are written into two buffers in turn. A completed frame raises
+// EVENT_ADC_FRAME; adc_scan_take() hands it to the main loop, and the
+// interrupt writes the following frames into the other buffer only, so the
+// frame stays unchanged until adc_scan_release() without holding
+// interrupts off while it is used. A frame that is not taken before the
+// next one completes is dropped and counted as an overrun.
+//
+//   adc_scan_start(channels, 3, 10);              // 3 channels every 10 ms
+//   ...
+//   if (event_take(EVENT_ADC_FRAME)) {
+//       const adc_frame_t *f = adc_scan_take();
+//       if (f) ... f->value[0 .. 2], f->time_ms
+//       adc_scan_release();
+//   }
+
+// Channels sampled at a time
+#ifndef ADC_MAX_CHANNELS
+#define ADC_MAX_CHANNELS 4
+#endif
+
+// Moving average length (power of two)
+#ifndef ADC_AVG_LEN
+#define ADC_AVG_LEN 4
+#endif
+
+#ifndef ADC_EMA_SHIFT
+#define ADC_EMA_SHIFT 3
+#endif
+
+// Up to 4^3 = 64 conversions per result: 13 bits, so sums and averages
+// stay within 16 bits
+#define ADC_OVERSAMPLE_MAX 3
+
+// Conversions per scan frame; 8 take 864 us, within one tick
+#ifndef ADC_SCAN_MAX
+#define ADC_SCAN_MAX 8
+#endif
+
+// ADC clock F_CPU / 128, the only prescaler within 50..200 kHz at 16 MHz
+#define ADC_CONVERSION_HZ (F_CPU / 128 / 13)
+
+typedef struct {
+    uint16_t value;                 // latest decimated result
+    uint16_t average;               // moving average of the last ADC_AVG_LEN
+    uint16_t ema;                   // exponential average
+    uint8_t bits;                   // resolution of the above: 10 + n
+    uint8_t seq;                    // incremented with each new result
+} adc_result_t;
+
+typedef struct {
+    uint32_t time_ms;               // tick that triggered the frame
+    uint16_t seq;                   // frames since adc_scan_start()
+    uint16_t value[ADC_SCAN_MAX];   // in the order of the channel list
+} adc_frame_t;
+
+// Start sampling the channels in 'mask' (bit 0 = ADC0 .. bit 7 = ADC7, up
+// to ADC_MAX_CHANNELS of them) against AVcc with 4^oversample_bits
+// conversions per result. False if the arguments are out of range.
+bool adc_start(uint8_t mask, uint8_t oversample_bits);
+
+// Stop free-running or scan mode
+void adc_stop(void);
+
+bool adc_running(void);
+
+// Latest results of a channel; false if it is not sampled or has no result
+// yet
+bool adc_read(uint8_t channel, adc_result_t *result);
+
+// Conversions per second (all channels) measured since adc_start() or
+// adc_scan_start()
+uint16_t adc_rate(void);
+
+// Start scan mode: convert channels[0 .. count - 1] (0..7, repeats allowed)
+// every 'period_ms' ticks. False if the arguments are out of range.
+bool adc_scan_start(const uint8_t *channels, uint8_t count, uint8_t period_ms);
+
+// Newest completed frame not taken yet, or NULL. It stays valid and
+// unchanged until adc_scan_release() or the next adc_scan_take().
+const adc_frame_t *adc_scan_take(void);
+
+void adc_scan_release(void);
+
+// Frames dropped because they were not taken in time
+uint16_t adc_scan_overruns(void);
+
+#endif // ADC_H
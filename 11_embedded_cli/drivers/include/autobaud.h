@@ -0,0 +1,32 @@
+#ifndef AUTOBAUD_H
+#define AUTOBAUD_H
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "uart.h"
+
+// Baud rate detection from a 'U' (0x55) sent by the host. On the wire 'U'
+// is start bit plus alternating data bits, so its five falling edges are
+// two bit times apart; the first to the last spans 8 bits.
+//
+// RXD (PD0) is polled with interrupts off and each falling edge is stamped
+// with Timer1 at clk/1. Arduino boards wire RXD, not ICP1 (PB0), to the
+// USB serial chip, so input capture would need a jumper. The polling loop
+// is 5 cycles, so each stamp has up to 4 cycles of jitter: enough from 2400
+// baud to 1 Mbaud at 16 MHz (2 Mbaud only works some of the time). A
+// character whose edges are not evenly spaced is ignored.
+//
+// Timer1 is taken over while measuring (see cycles.h), and the receiver is
+// disabled; the caller switches to the result with uart_set_divider().
+// The millisecond tick stands still while interrupts are off.
+
+// Largest error of the nearest UBRR setting that is accepted, percent
+#ifndef AUTOBAUD_TOL
+#define AUTOBAUD_TOL 3
+#endif
+
+// Wait up to 'timeout_ms' for a 'U'; true and the setting for its baud
+// rate in 'd' if one was seen
+bool autobaud_measure(uint16_t timeout_ms, uart_divider_t *d);
+
+#endif // AUTOBAUD_H
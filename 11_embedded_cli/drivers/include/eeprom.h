@@ -0,0 +1,64 @@
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include "avr/io.h"
+#include "stdint.h"
+#include "stdbool.h"
+
+// Background EEPROM writer. Programming one byte takes 1.8 to 3.4 ms and
+// the CPU may not touch the EEPROM meanwhile, so a polled block write
+// freezes the main loop for 3.4 ms per byte. Here writes are copied into a
+// queue and return at once; the EE_READY interrupt, which fires whenever
+// the EEPROM is idle, programs the queued bytes one after the other.
+//
+// - Unchanged bytes are not programmed at all: the interrupt compares each
+//   queued byte with the cell first. Rewriting a setting with the value it
+//   already has costs neither time nor wear.
+// - A changed byte is programmed with the shortest operation that does
+//   the job: erase only (1.8 ms) for 0xFF, write only (1.8 ms) into an
+//   erased 0xFF cell, erase + write (3.4 ms) otherwise.
+// - Writing an address that is still queued replaces the queued value.
+//
+// Reads see queued writes. Reading the EEPROM itself has to wait for the
+// byte being programmed, so reads go through a small cache of lines that
+// stays coherent with the queue: a line is read once and later reads and
+// writes to it do not touch the EEPROM.
+//
+//   eeprom_write(CONFIG_ADDR, &config, sizeof(config));   // returns at once
+//   eeprom_read(CONFIG_ADDR, &config, sizeof(config));
+
+#define EEPROM_SIZE (E2END + 1)
+
+// Queued bytes (3 bytes of SRAM each)
+#ifndef EEPROM_QUEUE_SIZE
+#define EEPROM_QUEUE_SIZE 32
+#endif
+
+// Read cache: EEPROM_CACHE_LINES lines of EEPROM_LINE_SIZE bytes
+#ifndef EEPROM_CACHE_LINES
+#define EEPROM_CACHE_LINES 4
+#endif
+#define EEPROM_LINE_SIZE 8
+
+// Read 'len' bytes at 'addr', queued writes included
+void eeprom_read(uint16_t addr, void *data, uint16_t len);
+
+uint8_t eeprom_read_byte(uint16_t addr);
+
+// Queue 'len' bytes for writing at 'addr'. Returns at once if the queue
+// has room for them (see eeprom_free()), otherwise waits for the interrupt
+// to make room, up to 3.4 ms per byte (interrupts must then be enabled).
+void eeprom_write(uint16_t addr, const void *data, uint16_t len);
+
+void eeprom_write_byte(uint16_t addr, uint8_t value);
+
+// Free queue entries: this many bytes can be written without waiting
+uint8_t eeprom_free(void);
+
+// True while writes are queued or a byte is being programmed
+bool eeprom_busy(void);
+
+// Wait until every queued byte has been programmed
+void eeprom_flush(void);
+
+#endif // EEPROM_H
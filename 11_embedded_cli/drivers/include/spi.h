@@ -0,0 +1,108 @@
+#ifndef SPI_H
+#define SPI_H
+
+#include "avr/io.h"
+#include "stdint.h"
+#include "stdbool.h"
+#include "stddef.h"
+
+// SPI master with a transaction queue. Transactions are submitted from the
+// main program and run one after the other in the background: the SPI
+// interrupt pumps each byte and calls the completion callback, so the main
+// loop (and the CLI) keeps running during long transfers.
+//
+// Short transactions are not worth an interrupt per byte (about 40 cycles
+// against 16 for a byte at F_CPU / 2). When the queue is idle and the
+// transfer is at most SPI_POLL_MAX bytes, spi_submit() runs it polled
+// before returning, loading the next byte and storing the last one while
+// the current one shifts.
+//
+//   static uint8_t cmd[4] = { 0x03, 0, 0, 0 }, data[16];
+//   static spi_transfer_t read_cmd = {
+//       .cs = SPI_CS(B, 2), .clock = SPI_DIV2, .mode = 0,
+//       .tx = cmd, .len = sizeof(cmd), .keep_cs = true,
+//   };
+//   static spi_transfer_t read_data = {
+//       .cs = SPI_CS(B, 2), .clock = SPI_DIV2, .mode = 0,
+//       .rx = data, .len = sizeof(data), .done = on_data,
+//   };
+//   spi_init();
+//   spi_cs_init(&read_cmd.cs);
+//   spi_submit(&read_cmd);
+//   spi_submit(&read_data);
+//
+// Pins: MOSI PB3, MISO PB4, SCK PB5 (the on-board LED). SS (PB2) is made
+// an output so the SPI stays master; it is free for use as a chip select.
+
+#ifndef SPI_POLL_MAX
+#define SPI_POLL_MAX 8
+#endif
+
+// Byte sent when a transaction has no tx buffer
+#define SPI_FILL 0xFF
+
+// SCK = F_CPU / n. Bit 2 is SPI2X, bits 1..0 are SPR1..0.
+#define SPI_DIV2    0x04
+#define SPI_DIV4    0x00
+#define SPI_DIV8    0x05
+#define SPI_DIV16   0x01
+#define SPI_DIV32   0x06
+#define SPI_DIV64   0x02
+#define SPI_DIV128  0x03
+
+// Transaction status
+#define SPI_DONE    0
+#define SPI_QUEUED  1
+#define SPI_BUSY    2
+
+// Chip select: a pin given as port letter and bit, e.g. SPI_CS(B, 2).
+// Active low; port NULL for none.
+typedef struct {
+    volatile uint8_t *port;
+    uint8_t mask;
+} spi_cs_t;
+
+#define SPI_CS(...) _SPI_CS(__VA_ARGS__)
+#define _SPI_CS(port, bit) { &PORT ## port, (uint8_t)(1 << (bit)) }
+
+typedef struct spi_transfer spi_transfer_t;
+
+// Called from the SPI interrupt (or from spi_submit() for a polled
+// transfer); may submit further transactions
+typedef void (*spi_callback_t)(spi_transfer_t *t);
+
+struct spi_transfer {
+    spi_cs_t cs;
+    uint8_t clock;                  // SPI_DIVn
+    uint8_t mode;                   // SPI mode 0..3 (bit 1 CPOL, bit 0 CPHA)
+    bool keep_cs;                   // leave CS low for the next transaction
+    const uint8_t *tx;              // NULL: send SPI_FILL
+    uint8_t *rx;                    // NULL: discard what comes in
+    uint16_t len;                   // at least 1
+    spi_callback_t done;            // may be NULL
+    void *context;                  // for the callback
+    volatile uint8_t status;        // SPI_*, set by the driver
+    spi_transfer_t *next;           // queue link, owned by the driver
+};
+
+// Configure the pins and enable the SPI as master
+void spi_init(void);
+
+// Disable the SPI and release MOSI/SCK/SS (e.g. to use the LED again);
+// the queue must be empty
+void spi_end(void);
+
+// Make a chip select pin an output, deselected
+void spi_cs_init(const spi_cs_t *cs);
+
+// Queue a transaction. It must stay valid, and not be resubmitted,
+// until its status is SPI_DONE.
+void spi_submit(spi_transfer_t *t);
+
+// Wait for a transaction to complete
+void spi_wait(spi_transfer_t *t);
+
+// True while transactions are queued or running
+bool spi_busy(void);
+
+#endif // SPI_H
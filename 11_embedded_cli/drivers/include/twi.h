@@ -0,0 +1,105 @@
+#ifndef TWI_H
+#define TWI_H
+
+#include "avr/io.h"
+#include "stdint.h"
+#include "stdbool.h"
+#include "stddef.h"
+#include "config.h"
+
+// Interrupt-driven TWI (I2C) master with a transaction queue. A blocking
+// transfer would hold the main loop for the whole time on the wire, about
+// 90 us per byte at 100 kHz; here the TWI interrupt runs the protocol one
+// step at a time and the main loop carries on.
+//
+// A transaction writes tx_len bytes and then, after a repeated start,
+// reads rx_len bytes from the same device; either part may be empty (both
+// empty probes the address). Transactions run one after the other in the
+// order submitted; the completion callback runs from the interrupt and may
+// submit more.
+//
+//   static uint8_t reg = 0x00, data[6];
+//   static twi_transfer_t read = {
+//       .address = 0x68, .tx = &reg, .tx_len = 1, .rx = data, .rx_len = 6,
+//   };
+//   twi_init(TWI_TWBR(400000));
+//   twi_submit(&read);
+//   ...
+//   if (twi_wait(&read) == TWI_OK) ...
+//
+// A transaction still running after TWI_TIMEOUT_MS (a device holding SCL
+// or SDA low) is aborted by twi_poll(), which the main loop calls: the bus
+// is recovered by clocking SCL until SDA is released, then a STOP.
+//
+// Pins: SDA PC4, SCL PC5, with the internal pull-ups on (too weak for
+// 400 kHz on their own; fit external 4.7k resistors).
+
+#ifndef TWI_TIMEOUT_MS
+#define TWI_TIMEOUT_MS 100
+#endif
+
+// TWBR for SCL = hz with the prescaler at 1. 100 kHz and 400 kHz need
+// F_CPU of at least 1.6 MHz and 6.4 MHz; 100 kHz fits TWBR up to 20 MHz.
+#define TWI_TWBR(hz) ((uint8_t)((F_CPU / (hz) - 16) / 2))
+
+// Transaction status: below TWI_QUEUED means finished
+#define TWI_OK          0
+#define TWI_NACK_ADDR   1   // no device answered the address
+#define TWI_NACK_DATA   2   // the device refused a written byte
+#define TWI_ARB_LOST    3   // another master took the bus
+#define TWI_BUS_ERROR   4   // illegal START/STOP seen on the bus
+#define TWI_TIMEOUT     5   // aborted after TWI_TIMEOUT_MS
+#define TWI_QUEUED      0x80
+#define TWI_BUSY        0x81
+
+typedef struct twi_transfer twi_transfer_t;
+
+typedef void (*twi_callback_t)(twi_transfer_t *t);
+
+struct twi_transfer {
+    uint8_t address;                // 7-bit device address
+    const uint8_t *tx;
+    uint8_t tx_len;
+    uint8_t *rx;
+    uint8_t rx_len;
+    twi_callback_t done;            // may be NULL
+    void *context;                  // for the callback
+    volatile uint8_t status;        // TWI_*, set by the driver
+    uint16_t micros;                // time from START to STOP, set by the driver
+    twi_transfer_t *next;           // queue link, owned by the driver
+};
+
+// Counters over all finished transactions; times in microseconds
+typedef struct {
+    uint16_t count;
+    uint16_t errors[TWI_TIMEOUT + 1];   // by status, errors[TWI_OK] unused
+    uint16_t min_us;
+    uint16_t max_us;
+    uint32_t total_us;
+    uint32_t bytes;
+} twi_stats_t;
+
+// Enable the TWI as master with the given bit rate (see TWI_TWBR)
+void twi_init(uint8_t twbr);
+
+// Disable the TWI and release the pins; the queue must be empty
+void twi_end(void);
+
+// Queue a transaction. It must stay valid, and not be resubmitted,
+// until it has finished.
+void twi_submit(twi_transfer_t *t);
+
+// Wait for a transaction to finish and return its status
+uint8_t twi_wait(twi_transfer_t *t);
+
+// True while transactions are queued or running
+bool twi_busy(void);
+
+// Abort a transaction stuck for longer than TWI_TIMEOUT_MS; call from the
+// main loop (twi_wait() calls it too)
+void twi_poll(void);
+
+void twi_stats(twi_stats_t *stats);
+void twi_stats_clear(void);
+
+#endif // TWI_H
@@ -6,11 +6,113 @@
 #include "stdbool.h"
 #include "pgmspace.h"
 
-#define BAUD 57600
-#define UBRR_VALUE ((F_CPU / (16UL * BAUD)) - 1)
+#ifndef BAUD
+#define BAUD 57600UL
+#endif
+#include "avr/baud.h"               // UBRR_VALUE, USE_U2X
+
+// Interrupt-driven receive buffer, power of two
+#ifndef UART_RX_BUFFER_SIZE
+#define UART_RX_BUFFER_SIZE 32
+#endif
+
+// RS-485 multi-drop mode (0/1): 9-bit frames with USART multi-processor
+// communication. A frame with the 9th bit set is an address; while MPCM0
+// is set the hardware ignores data frames, so traffic for other nodes
+// raises no interrupts. An address frame equal to UART_RS485_ADDRESS or
+// UART_RS485_BROADCAST clears MPCM0 and the data frames that follow reach
+// the receive buffer as usual; any other address sets it again. Address
+// frames are not stored.
+//
+// UART_DE_PIN drives the transceiver's driver enable (DE, and /RE tied to
+// it): high from the first byte written until the TX complete interrupt
+// after the last one, so the bus is released as soon as the stop bit ends.
+#ifndef UART_RS485
+#define UART_RS485 0
+#endif
+#ifndef UART_RS485_ADDRESS
+#define UART_RS485_ADDRESS 0x01
+#endif
+#define UART_RS485_BROADCAST 0xFF
+#ifndef UART_DE_PIN
+#define UART_DE_PIN D, 2
+#endif
+
+// Receive flow control, each optional (0/1). The RX interrupt pauses the
+// sender once UART_RX_HIGH_WATER bytes are waiting and uart_getc() lets
+// it go on at UART_RX_LOW_WATER. The room above the high watermark must
+// hold what the sender still has in flight: a byte or two for RTS/CTS on
+// a USB serial chip, more for XOFF through a host OS.
+//
+//   UART_FLOW_RTSCTS   RTS output, low while we can take data; CTS input,
+//                      low while the host can (pulled up, must be wired).
+//                      CTS held high for UART_CTS_TIMEOUT_MS is taken as
+//                      not wired: output goes on, ignoring CTS until it is
+//                      next seen low.
+//   UART_FLOW_XONXOFF  XOFF/XON sent from the receive path; XOFF/XON from
+//                      the host pause our output and are not stored, so
+//                      0x11 and 0x13 cannot be received as data. Output
+//                      goes on anyway after UART_XOFF_TIMEOUT_MS without
+//                      XON, so a stray XOFF (Ctrl-S in a terminal) cannot
+//                      hold up the main loop until the watchdog resets.
+#ifndef UART_FLOW_RTSCTS
+#define UART_FLOW_RTSCTS 0
+#endif
+#ifndef UART_FLOW_XONXOFF
+#define UART_FLOW_XONXOFF 0
+#endif
+#ifndef UART_XOFF_TIMEOUT_MS
+#define UART_XOFF_TIMEOUT_MS 250
+#endif
+#ifndef UART_CTS_TIMEOUT_MS
+#define UART_CTS_TIMEOUT_MS 250
+#endif
+#ifndef UART_RTS_PIN
+#define UART_RTS_PIN D, 7
+#endif
+#ifndef UART_CTS_PIN
+#define UART_CTS_PIN D, 6
+#endif
+#ifndef UART_RX_HIGH_WATER
+#define UART_RX_HIGH_WATER (UART_RX_BUFFER_SIZE * 3 / 4)
+#endif
+#ifndef UART_RX_LOW_WATER
+#define UART_RX_LOW_WATER (UART_RX_BUFFER_SIZE / 4)
+#endif
+
+#define UART_XON  0x11
+#define UART_XOFF 0x13
 
 void uart_init(void);
 
+// Runtime baud rate setting: UBRR0 and the U2X0 double-speed bit
+typedef struct {
+    uint16_t ubrr;
+    bool u2x;
+    uint16_t error;                 // |actual - wanted| / wanted, 1/100 percent
+} uart_divider_t;
+
+// Closest setting for a bit period of 'cycles8' / 8 CPU cycles (cycles8 =
+// 8 * F_CPU / baud); same choice as baud.h at compile time. False if the
+// rate is out of range.
+bool uart_divider(uint32_t cycles8, uart_divider_t *d);
+
+// Wait for the transmitter to finish, then switch to 'd'. Received bytes
+// still in the buffer are dropped.
+void uart_set_divider(const uart_divider_t *d);
+
+// Actual baud rate of the current setting
+uint32_t uart_baud(void);
+
+// Wait until every byte written has left the shift register
+void uart_flush(void);
+
+#if UART_RS485
+// Bus master: send an address frame selecting node 'address' (or
+// UART_RS485_BROADCAST) for the data bytes that follow
+void uart_rs485_select(uint8_t address);
+#endif
+
 void uart_putc(char c);
 void uart_puts(const char *str);
 void uart_print_ulong_width(unsigned long n, int width, char pad, bool plus, bool is_signed);
@@ -22,5 +124,6 @@ void uart_print_float_int(long val, int frac_digits, bool plus);
 void uart_print_scientific(double val, int precision, char exp_char, bool plus);
 
 char uart_getc(void);
+bool uart_available(void);
 
 #endif // UART_H
\ No newline at end of file
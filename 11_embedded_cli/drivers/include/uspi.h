@@ -0,0 +1,51 @@
+#ifndef USPI_H
+#define USPI_H
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "config.h"
+
+// USART0 in master SPI mode (MSPIM): MOSI on TXD (PD1), MISO on RXD (PD0),
+// SCK on XCK0 (PD4). SCK = F_CPU / (2 * (UBRR + 1)), so F_CPU / 2 at
+// UBRR 0.
+//
+// Unlike the SPI peripheral, the USART transmitter is double buffered:
+// the next byte can be written while the current one shifts out, so a
+// block goes out back to back with no gap between bytes even at F_CPU / 2
+// (the write loop needs fewer than the 16 cycles one byte takes). Useful
+// for LED strips, shift registers and displays, and as an output_putc
+// sink (output.h).
+//
+// USART0 is also the CLI's UART: uspi_begin() waits for the UART to finish,
+// saves its setup and takes the pins over, uspi_end() puts it back. Data
+// on TXD meanwhile reaches the host as noise unless it is all 0xFF.
+//
+//   uspi_begin(USPI_UBRR(8000000), USPI_MODE0, false);
+//   uspi_write(pixels, sizeof(pixels));
+//   uspi_end();
+
+// SPI modes: bit 1 = CPOL, bit 0 = CPHA
+#define USPI_MODE0 0
+#define USPI_MODE1 1
+#define USPI_MODE2 2
+#define USPI_MODE3 3
+
+// UBRR for the fastest SCK not above 'hz'
+#define USPI_UBRR(hz) ((uint16_t)((F_CPU + 2UL * (hz) - 1) / (2UL * (hz)) - 1))
+
+void uspi_begin(uint16_t ubrr, uint8_t mode, bool lsb_first);
+void uspi_end(void);
+
+// Send one byte and return the byte clocked in
+uint8_t uspi_transfer(uint8_t b);
+
+// Send a block back to back; received bytes are discarded
+void uspi_write(const uint8_t *data, uint16_t len);
+
+// Queue one byte (output_putc_t sink); returns as soon as it is buffered
+void uspi_putc(char c);
+
+// Wait until the last byte has been shifted out
+void uspi_flush(void);
+
+#endif // USPI_H
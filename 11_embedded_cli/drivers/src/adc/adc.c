@@ -0,0 +1,272 @@
+#include "adc.h"
+#include "tick.h"
+#include "events.h"
+#include "avr/interrupt.h"
+#include "string.h"
+
+#if ADC_AVG_LEN & (ADC_AVG_LEN - 1)
+#error "ADC_AVG_LEN must be a power of two"
+#endif
+#if (8191UL * ADC_AVG_LEN > 0xFFFF) || ((8191UL << ADC_EMA_SHIFT) > 0xFFFF)
+#error "ADC averages do not fit in 16 bits"
+#endif
+
+#if ADC_SCAN_MAX > 9
+#error "ADC_SCAN_MAX conversions must fit in one 1 ms tick"
+#endif
+
+#define ADC_REF_AVCC    (1 << REFS0)
+#define ADC_PRESCALE    ((1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0))
+#define ADC_SCAN_CTRL   ((1 << ADEN) | (1 << ADATE) | (1 << ADIE) | ADC_PRESCALE)
+#define NO_FRAME        0xFF
+
+typedef struct {
+    uint8_t channel;
+    uint8_t count;                  // conversions in 'acc'
+    uint16_t acc;
+    uint16_t value;
+    uint16_t sum;                   // of 'history'
+    uint16_t history[ADC_AVG_LEN];
+    uint8_t pos;
+    uint16_t ema;                   // ema << ADC_EMA_SHIFT
+    uint8_t seq;
+} adc_slot_t;
+
+static adc_slot_t slots[ADC_MAX_CHANNELS];
+static uint8_t slot_count;
+static uint8_t oversample;          // n: 4^n conversions per result
+static uint8_t reading;             // slot of the conversion that completes next
+static uint8_t converting;          // slot of the conversion after it
+static volatile uint32_t conversions;
+static uint32_t started_ms;
+
+// Scan mode
+static uint8_t scan_list[ADC_SCAN_MAX];
+static uint8_t scan_count;          // 0: scan mode off
+static uint8_t scan_pos;            // list entry being converted
+static uint8_t scan_period;
+static uint8_t scan_countdown;      // ticks until the next frame
+static uint16_t scan_seq;
+static adc_frame_t frames[2];
+static adc_frame_t *frame;          // being filled
+static volatile uint8_t frame_ready;    // index of the newest frame, or NO_FRAME
+static volatile uint8_t frame_held;     // index taken by the main loop, or NO_FRAME
+static volatile uint16_t overruns;
+
+static void add_result(adc_slot_t *s, uint16_t value) {
+    s->value = value;
+    if (s->seq == 0) {
+        // first result: start the averages from it rather than from zero
+        for (uint8_t i = 0; i < ADC_AVG_LEN; i++)
+            s->history[i] = value;
+        s->sum = value * ADC_AVG_LEN;
+        s->ema = value << ADC_EMA_SHIFT;
+    } else {
+        s->sum += value - s->history[s->pos];
+        s->history[s->pos] = value;
+        s->pos = (s->pos + 1) & (ADC_AVG_LEN - 1);
+        s->ema += value - (s->ema >> ADC_EMA_SHIFT);
+    }
+    if (++s->seq == 0)
+        s->seq = 1;                 // 0 means no result yet
+}
+
+static void free_running_result(uint16_t sample) {
+    adc_slot_t *s = &slots[reading];
+
+    // the conversion now running was set up last time; choose the one after
+    reading = converting;
+    if (++converting == slot_count)
+        converting = 0;
+    ADMUX = ADC_REF_AVCC | slots[converting].channel;
+
+    s->acc += sample;
+    if (++s->count < (uint8_t)(1 << (2 * oversample)))
+        return;
+    uint16_t value = s->acc >> oversample;
+    s->acc = 0;
+    s->count = 0;
+    add_result(s, value);
+}
+
+// Buffer for a new frame: never the one the main loop holds, and the
+// newest one only if that is the only choice (it is then dropped)
+static void begin_frame(void) {
+    uint8_t target;
+    if (frame_held != NO_FRAME)
+        target = frame_held ^ 1;
+    else if (frame_ready != NO_FRAME)
+        target = frame_ready ^ 1;
+    else
+        target = 0;
+    if (target == frame_ready) {
+        frame_ready = NO_FRAME;
+        overruns++;
+    }
+    frame = &frames[target];
+    frame->time_ms = tick_millis();
+}
+
+static void scan_result(uint16_t sample) {
+    if (scan_pos == 0) {
+        // a tick-triggered conversion: the first of a frame, or one between
+        // frames to drop
+        if (--scan_countdown)
+            return;
+        scan_countdown = scan_period;
+        begin_frame();
+    }
+
+    frame->value[scan_pos] = sample;
+    if (++scan_pos < scan_count) {
+        // the rest of the frame back to back
+        ADMUX = ADC_REF_AVCC | scan_list[scan_pos];
+        ADCSRA = ADC_SCAN_CTRL | (1 << ADSC);
+        return;
+    }
+
+    scan_pos = 0;
+    ADMUX = ADC_REF_AVCC | scan_list[0];
+    frame->seq = ++scan_seq;
+    if (frame_ready != NO_FRAME)
+        overruns++;
+    frame_ready = frame - frames;
+    event_set(EVENT_ADC_FRAME);
+}
+
+ISR(ADC_vect) {
+    uint16_t sample = ADCW;
+    conversions++;
+    if (scan_count)
+        scan_result(sample);
+    else
+        free_running_result(sample);
+}
+
+bool adc_start(uint8_t mask, uint8_t oversample_bits) {
+    if (oversample_bits > ADC_OVERSAMPLE_MAX || mask == 0)
+        return false;
+
+    uint8_t n = 0;
+    for (uint8_t ch = 0; ch < 8; ch++) {
+        if (mask & (1 << ch)) {
+            if (n == ADC_MAX_CHANNELS)
+                return false;
+            n++;
+        }
+    }
+
+    adc_stop();
+    memset(slots, 0, sizeof(slots));
+    slot_count = 0;
+    for (uint8_t ch = 0; ch < 8; ch++) {
+        if (mask & (1 << ch))
+            slots[slot_count++].channel = ch;
+    }
+    oversample = oversample_bits;
+    DIDR0 = mask & 0x3F;            // ADC6/7 have no digital input
+
+    // the multiplexer may only change once a conversion is under way, so
+    // the second conversion is on slot 0 as well; from the first interrupt
+    // on, each one selects the channel of the conversion after the running
+    // one
+    reading = 0;
+    converting = 0;
+    conversions = 0;
+    started_ms = tick_millis();
+    ADMUX = ADC_REF_AVCC | slots[0].channel;
+    ADCSRB = 0;                     // auto trigger: free running
+    ADCSRA = (1 << ADEN) | (1 << ADSC) | (1 << ADATE) | (1 << ADIF) | (1 << ADIE) | ADC_PRESCALE;
+    return true;
+}
+
+bool adc_scan_start(const uint8_t *channels, uint8_t count, uint8_t period_ms) {
+    if (count == 0 || count > ADC_SCAN_MAX || period_ms == 0)
+        return false;
+    uint8_t mask = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (channels[i] > 7)
+            return false;
+        mask |= 1 << channels[i];
+    }
+
+    adc_stop();
+    memcpy(scan_list, channels, count);
+    scan_count = count;
+    scan_pos = 0;
+    scan_period = period_ms;
+    scan_countdown = 1;
+    scan_seq = 0;
+    frame_ready = NO_FRAME;
+    frame_held = NO_FRAME;
+    overruns = 0;
+    DIDR0 = mask & 0x3F;
+
+    conversions = 0;
+    started_ms = tick_millis();
+    ADMUX = ADC_REF_AVCC | scan_list[0];
+    ADCSRB = (1 << ADTS1) | (1 << ADTS0);      // auto trigger: Timer0 compare A
+    ADCSRA = ADC_SCAN_CTRL | (1 << ADIF);
+    return true;
+}
+
+void adc_stop(void) {
+    ADCSRA = (1 << ADIF);
+    DIDR0 = 0;
+    slot_count = 0;
+    scan_count = 0;
+}
+
+bool adc_running(void) {
+    return slot_count != 0 || scan_count != 0;
+}
+
+bool adc_read(uint8_t channel, adc_result_t *result) {
+    for (uint8_t i = 0; i < slot_count; i++) {
+        adc_slot_t *s = &slots[i];
+        if (s->channel != channel)
+            continue;
+
+        uint8_t sreg = SREG;
+        cli();
+        result->value = s->value;
+        result->average = s->sum / ADC_AVG_LEN;
+        result->ema = s->ema >> ADC_EMA_SHIFT;
+        result->seq = s->seq;
+        SREG = sreg;
+        result->bits = 10 + oversample;
+        return result->seq != 0;
+    }
+    return false;
+}
+
+uint16_t adc_rate(void) {
+    uint8_t sreg = SREG;
+    cli();
+    uint32_t n = conversions;
+    SREG = sreg;
+    uint32_t ms = tick_millis() - started_ms;
+    return ms ? (uint16_t)(n * 1000 / ms) : 0;
+}
+
+const adc_frame_t *adc_scan_take(void) {
+    uint8_t sreg = SREG;
+    cli();
+    uint8_t ready = frame_ready;
+    frame_held = ready;
+    frame_ready = NO_FRAME;
+    SREG = sreg;
+    return (ready == NO_FRAME) ? NULL : &frames[ready];
+}
+
+void adc_scan_release(void) {
+    frame_held = NO_FRAME;
+}
+
+uint16_t adc_scan_overruns(void) {
+    uint8_t sreg = SREG;
+    cli();
+    uint16_t n = overruns;
+    SREG = sreg;
+    return n;
+}
@@ -0,0 +1,168 @@
+#include "eeprom.h"
+#include "avr/interrupt.h"
+
+#if EEPROM_QUEUE_SIZE > 255
+#error "EEPROM_QUEUE_SIZE must fit in 8 bits"
+#endif
+#if EEPROM_SIZE / EEPROM_LINE_SIZE > 255
+#error "Too many cache lines for 8-bit tags"
+#endif
+
+typedef struct {
+    uint16_t addr;
+    uint8_t value;
+} eeprom_entry_t;
+
+// Write queue, drained by the EE_READY interrupt
+static eeprom_entry_t queue[EEPROM_QUEUE_SIZE];
+static volatile uint8_t queue_head;     // next entry to program
+static volatile uint8_t queue_count;
+
+// Direct-mapped read cache holding the EEPROM as it will be once the queue
+// has drained. Tags are line number + 1, 0 for an empty slot.
+static uint8_t cache_tag[EEPROM_CACHE_LINES];
+static uint8_t cache[EEPROM_CACHE_LINES][EEPROM_LINE_SIZE];
+
+static inline uint8_t next(uint8_t i) {
+    return (i + 1 < EEPROM_QUEUE_SIZE) ? i + 1 : 0;
+}
+
+// Runs whenever EEPE is clear: program the next byte that differs from the
+// cell, or switch the interrupt off once the queue is empty
+ISR(EE_READY_vect) {
+    while (queue_count) {
+        eeprom_entry_t e = queue[queue_head];
+        queue_head = next(queue_head);
+        queue_count--;
+
+        EEAR = e.addr;
+        EECR |= (1 << EERE);
+        uint8_t old = EEDR;
+        if (old == e.value)
+            continue;
+
+        uint8_t mode = 0;                   // erase + write, 3.4 ms
+        if (e.value == 0xFF)
+            mode = (1 << EEPM0);            // erase only, 1.8 ms
+        else if (old == 0xFF)
+            mode = (1 << EEPM1);            // write only, 1.8 ms
+        EEDR = e.value;
+        EECR = (1 << EERIE) | mode;
+        // EEPE within 4 cycles of EEMPE: two sbi, whatever the optimiser does
+        __asm__ __volatile__ (
+            "sbi %0, %1"  "\n\t"
+            "sbi %0, %2"
+            :: "I" (_SFR_IO_ADDR(EECR)), "I" (EEMPE), "I" (EEPE)
+        );
+        return;
+    }
+    EECR = 0;
+}
+
+// Cache line holding 'addr', read from the EEPROM if needed
+static uint8_t *line(uint16_t addr) {
+    uint8_t n = addr / EEPROM_LINE_SIZE;
+    uint8_t slot = n % EEPROM_CACHE_LINES;
+    uint8_t *data = cache[slot];
+    if (cache_tag[slot] == n + 1)
+        return data;
+
+    // wait for the byte being programmed (up to 3.4 ms) with interrupts on,
+    // so the UART and the tick are served meanwhile. EERIE is off while
+    // waiting, or EE_READY would start the next queued byte as soon as EEPE
+    // clears and the wait would last until the queue is empty. With EEPE
+    // clear and interrupts off, every entry taken off the queue has been
+    // programmed and the rest is still in the queue.
+    uint8_t sreg = SREG;
+    cli();
+    EECR &= ~(1 << EERIE);
+    SREG = sreg;
+    while (EECR & (1 << EEPE));
+    cli();
+
+    uint16_t base = (uint16_t)n * EEPROM_LINE_SIZE;
+    for (uint8_t i = 0; i < EEPROM_LINE_SIZE; i++) {
+        EEAR = base + i;
+        EECR |= (1 << EERE);
+        data[i] = EEDR;
+    }
+    for (uint8_t i = 0, k = queue_head; i < queue_count; i++, k = next(k)) {
+        if (queue[k].addr / EEPROM_LINE_SIZE == n)
+            data[queue[k].addr % EEPROM_LINE_SIZE] = queue[k].value;
+    }
+    cache_tag[slot] = n + 1;
+
+    if (queue_count)
+        EECR |= (1 << EERIE);
+    SREG = sreg;
+    return data;
+}
+
+uint8_t eeprom_read_byte(uint16_t addr) {
+    addr &= E2END;
+    return line(addr)[addr % EEPROM_LINE_SIZE];
+}
+
+void eeprom_read(uint16_t addr, void *data, uint16_t len) {
+    uint8_t *p = data;
+    while (len--)
+        *p++ = eeprom_read_byte(addr++);
+}
+
+// Queue one byte; interrupts off and a free entry
+static void put(uint16_t addr, uint8_t value) {
+    uint8_t n = addr / EEPROM_LINE_SIZE;
+    uint8_t slot = n % EEPROM_CACHE_LINES;
+    if (cache_tag[slot] == n + 1) {
+        uint8_t *cached = &cache[slot][addr % EEPROM_LINE_SIZE];
+        if (*cached == value)
+            return;                         // already what it will be
+        *cached = value;
+    }
+
+    uint8_t k = queue_head;
+    for (uint8_t i = 0; i < queue_count; i++, k = next(k)) {
+        if (queue[k].addr == addr) {
+            queue[k].value = value;
+            return;
+        }
+    }
+    queue[k] = (eeprom_entry_t){ addr, value };
+    queue_count++;
+    EECR |= (1 << EERIE);
+}
+
+void eeprom_write_byte(uint16_t addr, uint8_t value) {
+    eeprom_write(addr, &value, 1);
+}
+
+void eeprom_write(uint16_t addr, const void *data, uint16_t len) {
+    const uint8_t *p = data;
+    uint8_t sreg = SREG;
+
+    while (len--) {
+        // wait with interrupts on for EE_READY to make room; SREG = sreg
+        // then cli() would give it no chance to run
+        for (;;) {
+            while (eeprom_free() == 0);
+            cli();
+            if (queue_count < EEPROM_QUEUE_SIZE)
+                break;
+            SREG = sreg;
+        }
+        put(addr++ & E2END, *p++);
+        SREG = sreg;
+    }
+}
+
+uint8_t eeprom_free(void) {
+    return EEPROM_QUEUE_SIZE - queue_count;
+}
+
+bool eeprom_busy(void) {
+    return queue_count || (EECR & (1 << EEPE));
+}
+
+void eeprom_flush(void) {
+    while (eeprom_busy());
+}
@@ -0,0 +1,179 @@
+#include "spi.h"
+#include "avr/interrupt.h"
+#include "avr/gpio.h"
+
+#define SS_PIN      B, 2
+#define MOSI_PIN    B, 3
+#define SCK_PIN     B, 5
+
+// The PORTB bits spi_init() changes; spi_end() puts back only these
+#define SPI_PINS    ((1 << 2) | (1 << 3) | (1 << 5))
+#define SS_MASK     (1 << 2)
+
+// Queue of submitted transactions; 'head' is the one running
+static spi_transfer_t *volatile head;
+static spi_transfer_t *tail;
+static uint16_t pos;                // next byte of 'head' to store
+static uint8_t saved_ddrb;          // SPI_PINS of DDRB before spi_init()
+static uint8_t saved_portb;         // SS_MASK of PORTB before spi_init()
+
+// Clock and mode of a transaction, with or without the interrupt
+static void apply(const spi_transfer_t *t, bool irq) {
+    SPCR = (1 << SPE) | (1 << MSTR)
+         | (irq ? (1 << SPIE) : 0)
+         | ((t->mode & 2) ? (1 << CPOL) : 0)
+         | ((t->mode & 1) ? (1 << CPHA) : 0)
+         | (t->clock & 0x03);
+    SPSR = (t->clock & 0x04) ? (1 << SPI2X) : 0;
+}
+
+// Chip select changes read-modify-write the port: interrupts must be off
+static inline void cs_select(const spi_cs_t *cs) {
+    if (cs->port)
+        *cs->port &= ~cs->mask;
+}
+
+static inline void cs_release(const spi_cs_t *cs) {
+    if (cs->port)
+        *cs->port |= cs->mask;
+}
+
+// Start an interrupt-driven transaction (interrupts off)
+static void start(spi_transfer_t *t) {
+    t->status = SPI_BUSY;
+    pos = 0;
+    apply(t, true);
+    cs_select(&t->cs);
+    SPDR = t->tx ? t->tx[0] : SPI_FILL;
+}
+
+// Take 'head' off the queue, report it and start the next one
+// (interrupts off)
+static void complete(spi_transfer_t *t) {
+    head = t->next;
+    if (head == NULL)
+        tail = NULL;
+
+    if (!t->keep_cs)
+        cs_release(&t->cs);
+    t->status = SPI_DONE;
+    if (t->done)
+        t->done(t);
+
+    // the callback may have submitted, and even finished, more work
+    spi_transfer_t *next = head;
+    if (next != NULL && next->status == SPI_QUEUED)
+        start(next);
+}
+
+ISR(SPI_STC_vect) {
+    spi_transfer_t *t = head;
+    uint8_t in = SPDR;
+
+    if (t->rx)
+        t->rx[pos] = in;
+    if (++pos < t->len) {
+        SPDR = t->tx ? t->tx[pos] : SPI_FILL;
+        return;
+    }
+    complete(t);
+}
+
+// Polled transfer with interrupts enabled and the SPI interrupt off. The
+// next byte is fetched while the current one shifts, so after SPIF only
+// the SPDR read and write are left before the next byte starts.
+static void run_polled(spi_transfer_t *t) {
+    const uint8_t *tx = t->tx;
+    uint8_t *rx = t->rx;
+    uint16_t n = t->len;
+
+    apply(t, false);
+    uint8_t sreg = SREG;
+    cli();
+    cs_select(&t->cs);
+    SREG = sreg;
+
+    SPDR = tx ? *tx++ : SPI_FILL;
+    while (--n) {
+        uint8_t next = tx ? *tx++ : SPI_FILL;
+        while (!(SPSR & (1 << SPIF)));
+        uint8_t in = SPDR;
+        SPDR = next;
+        if (rx)
+            *rx++ = in;
+    }
+    while (!(SPSR & (1 << SPIF)));
+    uint8_t in = SPDR;
+    if (rx)
+        *rx = in;
+}
+
+void spi_init(void) {
+    saved_ddrb = DDRB & SPI_PINS;
+    saved_portb = PORTB & SS_MASK;
+    gpio_set(SS_PIN);               // deselected if used as a chip select
+    gpio_output(SS_PIN);
+    gpio_output(MOSI_PIN);
+    gpio_output(SCK_PIN);
+    SPCR = (1 << SPE) | (1 << MSTR);
+    SPSR = 0;
+}
+
+void spi_end(void) {
+    SPCR = 0;
+    SPSR = 0;
+    // other pins of the port may have changed since (chip selects), and an
+    // interrupt may change them now
+    uint8_t sreg = SREG;
+    cli();
+    DDRB = (DDRB & ~SPI_PINS) | saved_ddrb;
+    PORTB = (PORTB & ~SS_MASK) | saved_portb;
+    SREG = sreg;
+}
+
+void spi_cs_init(const spi_cs_t *cs) {
+    if (!cs->port)
+        return;
+    uint8_t sreg = SREG;
+    cli();
+    *cs->port |= cs->mask;
+    *(cs->port - 1) |= cs->mask;    // DDRx sits just below PORTx
+    SREG = sreg;
+}
+
+void spi_submit(spi_transfer_t *t) {
+    t->next = NULL;
+    t->status = SPI_QUEUED;
+
+    uint8_t sreg = SREG;
+    cli();
+    if (tail != NULL) {             // runs when its turn comes
+        tail->next = t;
+        tail = t;
+        SREG = sreg;
+        return;
+    }
+    head = tail = t;
+    if (t->len > SPI_POLL_MAX) {
+        start(t);
+        SREG = sreg;
+        return;
+    }
+
+    // short and the bus is free: run it now. Being 'head' keeps anything
+    // submitted meanwhile (e.g. from another interrupt) queued behind it.
+    t->status = SPI_BUSY;
+    SREG = sreg;
+    run_polled(t);
+    cli();
+    complete(t);
+    SREG = sreg;
+}
+
+void spi_wait(spi_transfer_t *t) {
+    while (t->status != SPI_DONE);
+}
+
+bool spi_busy(void) {
+    return head != NULL;
+}
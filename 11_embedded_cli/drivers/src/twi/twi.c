@@ -0,0 +1,244 @@
+#include "twi.h"
+#include "tick.h"
+#include "avr/interrupt.h"
+#include "avr/gpio.h"
+#include "avr/delay.h"
+
+#define SDA_PIN     C, 4
+#define SCL_PIN     C, 5
+
+// TWSR status codes, master transmitter and receiver
+#define TW_BUS_ERROR    0x00
+#define TW_START        0x08
+#define TW_REP_START    0x10
+#define TW_MT_SLA_ACK   0x18
+#define TW_MT_SLA_NACK  0x20
+#define TW_MT_DATA_ACK  0x28
+#define TW_MT_DATA_NACK 0x30
+#define TW_ARB_LOST     0x38
+#define TW_MR_SLA_ACK   0x40
+#define TW_MR_SLA_NACK  0x48
+#define TW_MR_DATA_ACK  0x50
+#define TW_MR_DATA_NACK 0x58
+
+// Go on to the next step with the interrupt enabled
+#define TWCR_NEXT   ((1 << TWINT) | (1 << TWEN) | (1 << TWIE))
+#define TWCR_STOP   (1 << TWSTO)
+
+// Queue of submitted transactions; 'head' is the one running
+static twi_transfer_t *volatile head;
+static twi_transfer_t *tail;
+static uint8_t pos;                 // next byte of 'head' to write or read
+static uint32_t started_us;         // START of 'head'
+static twi_stats_t stats = { .min_us = 0xFFFF };
+
+// Send a START, after a STOP if 'stop' (interrupts off)
+static void start(twi_transfer_t *t, uint8_t stop) {
+    t->status = TWI_BUSY;
+    pos = 0;
+    started_us = tick_micros();
+    TWCR = TWCR_NEXT | (1 << TWSTA) | stop;
+}
+
+static void record(const twi_transfer_t *t, uint8_t status) {
+    stats.count++;
+    if (status != TWI_OK) {
+        stats.errors[status]++;
+        return;
+    }
+    stats.bytes += t->tx_len + t->rx_len;
+    stats.total_us += t->micros;
+    if (t->micros < stats.min_us)
+        stats.min_us = t->micros;
+    if (t->micros > stats.max_us)
+        stats.max_us = t->micros;
+}
+
+// Finish 'head' and start the next transaction, or release the bus when
+// there is none. 'stop' is TWCR_STOP to end with a STOP condition.
+// Interrupts off.
+static void finish(uint8_t status, uint8_t stop) {
+    twi_transfer_t *t = head;
+    uint32_t us = tick_micros() - started_us;
+    t->micros = (us > 0xFFFF) ? 0xFFFF : (uint16_t)us;
+    record(t, status);
+
+    head = t->next;
+    if (head == NULL) {
+        tail = NULL;
+        TWCR = (1 << TWINT) | (1 << TWEN) | stop;
+    } else {
+        start(head, stop);
+    }
+
+    t->status = status;
+    if (t->done)
+        t->done(t);
+}
+
+ISR(TWI_vect) {
+    twi_transfer_t *t = head;
+
+    switch (TWSR & 0xF8) {
+    case TW_START:
+        if (t->tx_len || !t->rx_len) {
+            TWDR = t->address << 1;         // SLA+W
+            TWCR = TWCR_NEXT;
+            break;
+        }
+        // nothing to write: read straight away
+        // fall through
+    case TW_REP_START:
+        TWDR = (t->address << 1) | 1;       // SLA+R
+        TWCR = TWCR_NEXT;
+        break;
+
+    case TW_MT_DATA_NACK:
+        if (pos < t->tx_len) {
+            finish(TWI_NACK_DATA, TWCR_STOP);
+            break;
+        }
+        // the last byte written may be refused
+        // fall through
+    case TW_MT_SLA_ACK:
+    case TW_MT_DATA_ACK:
+        if (pos < t->tx_len) {
+            TWDR = t->tx[pos++];
+            TWCR = TWCR_NEXT;
+        } else if (t->rx_len) {
+            TWCR = TWCR_NEXT | (1 << TWSTA);
+        } else {
+            finish(TWI_OK, TWCR_STOP);
+        }
+        break;
+
+    case TW_MT_SLA_NACK:
+    case TW_MR_SLA_NACK:
+        finish(TWI_NACK_ADDR, TWCR_STOP);
+        break;
+
+    // acknowledge every byte but the last
+    case TW_MR_SLA_ACK:
+        pos = 0;
+        TWCR = TWCR_NEXT | ((t->rx_len > 1) ? (1 << TWEA) : 0);
+        break;
+    case TW_MR_DATA_ACK:
+        t->rx[pos++] = TWDR;
+        TWCR = TWCR_NEXT | ((pos + 1 < t->rx_len) ? (1 << TWEA) : 0);
+        break;
+    case TW_MR_DATA_NACK:
+        t->rx[pos] = TWDR;
+        finish(TWI_OK, TWCR_STOP);
+        break;
+
+    case TW_ARB_LOST:
+        // the bus belongs to the other master: no STOP of our own
+        finish(TWI_ARB_LOST, 0);
+        break;
+
+    default:
+        // TW_BUS_ERROR: the STOP only resets the TWI, nothing is sent
+        finish(TWI_BUS_ERROR, TWCR_STOP);
+        break;
+    }
+}
+
+// Open-drain outputs by hand: drive the line low, or let the pull-up
+// take it high
+static inline void scl_low(void)     { gpio_clear(SCL_PIN); gpio_output(SCL_PIN); }
+static inline void scl_release(void) { gpio_input(SCL_PIN); gpio_pullup(SCL_PIN); }
+static inline void sda_low(void)     { gpio_clear(SDA_PIN); gpio_output(SDA_PIN); }
+static inline void sda_release(void) { gpio_input(SDA_PIN); gpio_pullup(SDA_PIN); }
+
+// A device interrupted mid-byte holds SDA low until it has clocked out the
+// rest of the byte and its ack: pulse SCL (at most 9 times) until SDA is
+// released, then send a STOP so every device resets its state machine.
+static void recover(void) {
+    for (uint8_t i = 0; i < 9 && !gpio_read(SDA_PIN); i++) {
+        scl_low();
+        delay_us(5);
+        scl_release();
+        delay_us(5);
+    }
+    scl_low();
+    sda_low();
+    delay_us(5);
+    scl_release();
+    delay_us(5);
+    sda_release();
+    delay_us(5);
+}
+
+void twi_init(uint8_t twbr) {
+    gpio_pullup(SDA_PIN);
+    gpio_pullup(SCL_PIN);
+    TWSR = 0;                       // prescaler 1
+    TWBR = twbr;
+    TWCR = (1 << TWEN);
+}
+
+void twi_end(void) {
+    TWCR = 0;
+    gpio_clear(SDA_PIN);
+    gpio_clear(SCL_PIN);
+}
+
+void twi_submit(twi_transfer_t *t) {
+    t->next = NULL;
+    t->status = TWI_QUEUED;
+
+    uint8_t sreg = SREG;
+    cli();
+    if (tail != NULL) {
+        tail->next = t;
+        tail = t;
+    } else {
+        head = tail = t;
+        while (TWCR & (1 << TWSTO));    // the last transaction's STOP
+        start(t, 0);
+    }
+    SREG = sreg;
+}
+
+uint8_t twi_wait(twi_transfer_t *t) {
+    while (t->status >= TWI_QUEUED)
+        twi_poll();
+    return t->status;
+}
+
+bool twi_busy(void) {
+    return head != NULL;
+}
+
+void twi_poll(void) {
+    uint8_t sreg = SREG;
+    cli();
+    if (head == NULL || tick_micros() - started_us < TWI_TIMEOUT_MS * 1000UL) {
+        SREG = sreg;
+        return;
+    }
+
+    // stop the state machine; new submissions queue behind 'head'
+    TWCR = 0;
+    SREG = sreg;
+    recover();
+
+    cli();
+    TWCR = (1 << TWEN);
+    finish(TWI_TIMEOUT, 0);
+    SREG = sreg;
+}
+
+void twi_stats(twi_stats_t *out) {
+    uint8_t sreg = SREG;
+    cli();
+    *out = stats;
+    SREG = sreg;
+}
+
+void twi_stats_clear(void) {
+    uint8_t sreg = SREG;
+    cli();
+    stats = (twi_stats_t){ .min_us = 0xFFFF };
+    SREG = sreg;
+}
@@ -0,0 +1,84 @@
+#include "autobaud.h"
+#include "avr/io.h"
+#include "avr/interrupt.h"
+#include "avr/gpio.h"
+#include "config.h"
+
+#define RX_PIN      D, 0            // RXD
+#define SYNC_EDGES  5               // falling edges of 'U', 2 bits apart
+
+// Both waits give up when OCF1A is set. They are not inlined so every
+// timestamp is taken by the same instructions: the fixed delay from the
+// edge to the TCNT1 read cancels out of the differences.
+static __attribute__((noinline)) bool wait_high(void) {
+    while (!gpio_read(RX_PIN)) {
+        if (TIFR1 & (1 << OCF1A))
+            return false;
+    }
+    return true;
+}
+
+static __attribute__((noinline)) bool wait_falling(uint16_t *stamp) {
+    while (gpio_read(RX_PIN)) {
+        if (TIFR1 & (1 << OCF1A))
+            return false;
+    }
+    *stamp = TCNT1;
+    return true;
+}
+
+// Time out one full Timer1 period (65535 cycles) after 'from'
+static void set_timeout(uint16_t from) {
+    OCR1A = from - 1;
+    TIFR1 = (1 << OCF1A);
+}
+
+// Stamps of one character, true if they look like 'U'
+static bool measure_char(uint16_t stamp[SYNC_EDGES]) {
+    set_timeout(TCNT1);
+    if (!wait_high() || !wait_falling(&stamp[0]))
+        return false;
+
+    // 8 bits at 2400 baud or faster fit in one Timer1 period
+    set_timeout(stamp[0]);
+    for (uint8_t i = 1; i < SYNC_EDGES; i++) {
+        if (!wait_high() || !wait_falling(&stamp[i]))
+            return false;
+    }
+
+    // every gap must be two bit times, within a quarter of that
+    uint16_t span = stamp[SYNC_EDGES - 1] - stamp[0];
+    uint16_t gap = span / 4;
+    for (uint8_t i = 1; i < SYNC_EDGES; i++) {
+        uint16_t d = stamp[i] - stamp[i - 1];
+        if (d < gap - gap / 4 || d > gap + gap / 4)
+            return false;
+    }
+    return true;
+}
+
+bool autobaud_measure(uint16_t timeout_ms, uart_divider_t *d) {
+    uint16_t periods = (uint16_t)(((uint32_t)timeout_ms * (F_CPU / 1000)) >> 16) + 1;
+    uint16_t stamp[SYNC_EDGES];
+    bool found = false;
+
+    uint8_t sreg = SREG;
+    cli();
+    uint8_t ucsrb = UCSR0B;
+    UCSR0B = ucsrb & ~((1 << RXEN0) | (1 << RXCIE0));  // RXD back to a plain input
+    TCCR1A = 0;
+    TCCR1B = (1 << CS10);
+
+    // a bad character ends its attempt early, so this is an upper bound
+    while (!found && periods--) {
+        if (measure_char(stamp) &&
+            uart_divider(stamp[SYNC_EDGES - 1] - stamp[0], d) &&
+            d->error <= AUTOBAUD_TOL * 100)
+            found = true;
+    }
+
+    TCCR1B = 0;
+    UCSR0B = ucsrb;
+    SREG = sreg;
+    return found;
+}
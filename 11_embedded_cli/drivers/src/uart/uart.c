@@ -1,18 +1,295 @@
 #include "avr/io.h"
 #include "uart.h"
+#include "events.h"
+#include "tick.h"
+#include "avr/gpio.h"
+#include "avr/interrupt.h"
 #include "std/pgmspace.h"
 
+// --- Receive buffer ---
+// Filled by the RX complete interrupt, drained by uart_getc(). One slot is
+// kept free to tell a full buffer from an empty one; bytes arriving while
+// it is full are dropped, which flow control is there to prevent.
+#define UART_RX_MASK (UART_RX_BUFFER_SIZE - 1)
+#define UART_FLOW    (UART_FLOW_RTSCTS || UART_FLOW_XONXOFF)
+
+#if (UART_RX_BUFFER_SIZE & UART_RX_MASK) != 0 || UART_RX_BUFFER_SIZE > 256
+#error "UART_RX_BUFFER_SIZE must be a power of two, at most 256"
+#endif
+#if UART_RS485 && UART_FLOW
+#error "Flow control is not supported on an RS-485 bus"
+#endif
+#if UART_FLOW && (UART_RX_HIGH_WATER >= UART_RX_BUFFER_SIZE || UART_RX_LOW_WATER >= UART_RX_HIGH_WATER)
+#error "UART watermarks must satisfy LOW < HIGH < UART_RX_BUFFER_SIZE"
+#endif
+
+static volatile uint8_t rx_buffer[UART_RX_BUFFER_SIZE];
+static volatile uint8_t rx_head;    // written by the ISR only
+static volatile uint8_t rx_tail;    // written by uart_getc() only
+static bool tx_used;                // TXC0 is only meaningful after a write
+
+#if UART_FLOW
+static volatile bool rx_stopped;    // sender asked to pause
+#endif
+#if UART_FLOW_RTSCTS
+static bool cts_stuck;              // CTS timed out, ignored until low
+#endif
+#if UART_FLOW_XONXOFF
+static volatile uint8_t tx_control; // XON/XOFF still to send, 0 if none
+static volatile bool tx_paused;     // host sent XOFF
+#endif
+
+static inline uint8_t rx_level(void) {
+    return (uint8_t)(rx_head - rx_tail) & UART_RX_MASK;
+}
+
+// Write a byte to the empty data register
+static inline void tx_write(uint8_t c) {
+#if UART_RS485
+    gpio_set(UART_DE_PIN);          // released by the TX complete interrupt
+#endif
+    // clear TXC0 (write one) so uart_flush() waits for this byte; the
+    // error flags must be written as zero
+    UCSR0A = (UCSR0A & ((1 << U2X0) | (1 << MPCM0))) | (1 << TXC0);
+    UDR0 = c;
+    tx_used = true;
+}
+
+#if UART_FLOW_XONXOFF
+// Write a byte from the main program. The receive interrupt may write XOFF
+// to UDR0 or leave it pending, so test and write with interrupts off; a
+// pending XOFF goes first.
+static void tx_put(uint8_t c) {
+    for (;;) {
+        while (!(UCSR0A & (1 << UDRE0)));
+        uint8_t sreg = SREG;
+        cli();
+        uint8_t control = 0;
+        bool ready = UCSR0A & (1 << UDRE0);
+        if (ready) {
+            control = tx_control;
+            tx_control = 0;
+            tx_write(control ? control : c);
+        }
+        SREG = sreg;
+        if (ready && !control)
+            return;
+    }
+}
+#endif
+
+#if UART_FLOW
+// Pause the sender, from the receive interrupt
+static void rx_stop(void) {
+    rx_stopped = true;
+#if UART_FLOW_RTSCTS
+    gpio_set(UART_RTS_PIN);
+#endif
+#if UART_FLOW_XONXOFF
+    if (UCSR0A & (1 << UDRE0))
+        tx_write(UART_XOFF);
+    else
+        tx_control = UART_XOFF;     // sent by tx_put() or the next interrupt
+#endif
+}
+
+// Let the sender go on once the buffer has drained to the low watermark
+static void rx_resume_check(void) {
+    if (!rx_stopped || rx_level() > UART_RX_LOW_WATER)
+        return;
+
+    uint8_t sreg = SREG;
+    cli();
+    bool resume = rx_stopped && rx_level() <= UART_RX_LOW_WATER;
+    if (resume) {
+        rx_stopped = false;
+#if UART_FLOW_RTSCTS
+        gpio_clear(UART_RTS_PIN);
+#endif
+    }
+    SREG = sreg;
+
+#if UART_FLOW_XONXOFF
+    if (resume)
+        tx_put(UART_XON);           // even while the host has paused us
+#endif
+}
+#endif
+
+ISR(USART_RX_vect) {
+#if UART_RS485
+    bool address = UCSR0B & (1 << RXB80);   // must be read before UDR0
+#endif
+    uint8_t c = UDR0;               // reading UDR0 clears RXC0
+
+#if UART_RS485
+    if (address) {
+        // TXC0 is written as zero, which leaves it alone
+        if (c == UART_RS485_ADDRESS || c == UART_RS485_BROADCAST)
+            UCSR0A = UCSR0A & (1 << U2X0);                      // take data frames
+        else
+            UCSR0A = (UCSR0A & (1 << U2X0)) | (1 << MPCM0);     // ignore them
+        return;
+    }
+#endif
+
+#if UART_FLOW_XONXOFF
+    if (c == UART_XOFF || c == UART_XON) {
+        tx_paused = (c == UART_XOFF);
+        return;
+    }
+#endif
+
+    uint8_t head = rx_head;
+    uint8_t next = (head + 1) & UART_RX_MASK;
+
+    if (next != rx_tail) {
+        rx_buffer[head] = c;
+        rx_head = next;
+    }
+
+#if UART_FLOW
+    if (!rx_stopped) {
+        if (rx_level() >= UART_RX_HIGH_WATER)
+            rx_stop();
+    }
+#if UART_FLOW_XONXOFF
+    else if (tx_control && (UCSR0A & (1 << UDRE0))) {
+        tx_write(tx_control);       // XOFF that found the transmitter busy
+        tx_control = 0;
+    }
+#endif
+#endif
+    event_set(EVENT_UART_RX);
+}
+
+#if UART_RS485
+// Last stop bit sent and nothing more to send: release the bus. cbi
+// changes no register or flag, so no prologue is needed.
+ISR(USART_TX_vect, ISR_NAKED) {
+    gpio_clear(UART_DE_PIN);
+    reti();
+}
+#endif
+
 // --- UART init / putchar ---
 void uart_init(void) {
     UBRR0H = (uint8_t)(UBRR_VALUE >> 8);
     UBRR0L = (uint8_t)(UBRR_VALUE & 0xFF);
-    UCSR0B = (1 << TXEN0) | (1 << RXEN0); // Enable TX and RX
+#if USE_U2X
+    UCSR0A = (1 << U2X0);                   // double speed, 8 samples per bit
+#else
+    UCSR0A = 0;
+#endif
+#if UART_RS485
+    gpio_clear(UART_DE_PIN);                // listen
+    gpio_output(UART_DE_PIN);
+    UCSR0A = (UCSR0A & (1 << U2X0)) | (1 << MPCM0);   // wait for our address
+    UCSR0B = (1 << TXEN0) | (1 << RXEN0) | (1 << RXCIE0) | (1 << TXCIE0) | (1 << UCSZ02);
+    UCSR0C = (1 << UCSZ01) | (1 << UCSZ00); // 9N1, TXB80 = 0: data frames
+#else
+    UCSR0B = (1 << TXEN0) | (1 << RXEN0) | (1 << RXCIE0); // Enable TX, RX and RX interrupt
     UCSR0C = (1 << UCSZ01) | (1 << UCSZ00); // 8N1
+#endif
+#if UART_FLOW_RTSCTS
+    gpio_clear(UART_RTS_PIN);               // ready to receive
+    gpio_output(UART_RTS_PIN);
+    gpio_input(UART_CTS_PIN);
+    gpio_pullup(UART_CTS_PIN);
+#endif
 }
 
 void uart_putc(char c) {
+#if UART_FLOW_RTSCTS
+    if (!gpio_read(UART_CTS_PIN)) {
+        cts_stuck = false;                  // host ready: honour CTS again
+    } else if (!cts_stuck) {                // host cannot take more
+        uint32_t start = tick_millis();
+        while (gpio_read(UART_CTS_PIN)) {
+            if (tick_millis() - start >= UART_CTS_TIMEOUT_MS) {
+                cts_stuck = true;           // not wired or stuck: carry on
+                break;
+            }
+        }
+    }
+#endif
+#if UART_FLOW_XONXOFF
+    if (tx_paused) {                        // host sent XOFF
+        uint32_t start = tick_millis();
+        while (tx_paused) {
+            if (tick_millis() - start >= UART_XOFF_TIMEOUT_MS) {
+                tx_paused = false;          // no XON: carry on
+                break;
+            }
+        }
+    }
+    tx_put(c);
+#else
     while (!(UCSR0A & (1 << UDRE0)));
-    UDR0 = c;
+    tx_write(c);
+#endif
+}
+
+void uart_flush(void) {
+    if (!tx_used)
+        return;
+#if UART_RS485
+    while (gpio_read(UART_DE_PIN));         // the TXC interrupt takes TXC0
+#else
+    while (!(UCSR0A & (1 << TXC0)));
+#endif
+}
+
+#if UART_RS485
+void uart_rs485_select(uint8_t address) {
+    while (!(UCSR0A & (1 << UDRE0)));
+    UCSR0B |= (1 << TXB80);                 // before UDR0 is written
+    tx_write(address);
+    // the 9th bit goes with the byte into the shift register
+    while (!(UCSR0A & (1 << UDRE0)));
+    UCSR0B &= ~(1 << TXB80);
+}
+#endif
+
+// --- Runtime baud rate ---
+bool uart_divider(uint32_t cycles8, uart_divider_t *d) {
+    // UBRR + 1 for 16 (normal) and 8 (U2X) samples per bit, rounded
+    uint32_t div_1x = (cycles8 + 64) / 128;
+    uint32_t div_2x = (cycles8 + 32) / 64;
+    if (div_2x == 0 || div_1x > 4096)
+        return false;
+
+    uint32_t err_1x = (cycles8 > div_1x * 128) ? cycles8 - div_1x * 128 : div_1x * 128 - cycles8;
+    uint32_t err_2x = (cycles8 > div_2x * 64) ? cycles8 - div_2x * 64 : div_2x * 64 - cycles8;
+
+    // as in baud.h: normal mode unless U2X is strictly closer
+    if (div_1x == 0 || (div_2x <= 4096 && err_2x < err_1x)) {
+        d->ubrr = div_2x - 1;
+        d->u2x = true;
+        d->error = err_2x * 10000 / cycles8;
+    } else {
+        d->ubrr = div_1x - 1;
+        d->u2x = false;
+        d->error = err_1x * 10000 / cycles8;
+    }
+    return true;
+}
+
+void uart_set_divider(const uart_divider_t *d) {
+    uart_flush();
+    UBRR0H = (uint8_t)(d->ubrr >> 8);
+    UBRR0L = (uint8_t)(d->ubrr & 0xFF);     // takes effect immediately
+    UCSR0A = (UCSR0A & (1 << MPCM0)) | (d->u2x ? (1 << U2X0) : 0);
+    rx_tail = rx_head;
+#if UART_FLOW
+    rx_resume_check();
+#endif
+}
+
+uint32_t uart_baud(void) {
+    uint16_t ubrr = ((uint16_t)(UBRR0H & 0x0F) << 8) | UBRR0L;
+    uint8_t samples = (UCSR0A & (1 << U2X0)) ? 8 : 16;
+    return F_CPU / ((uint32_t)samples * (ubrr + 1));
 }
 
 void uart_puts(const char *str) {
@@ -24,8 +301,19 @@ void uart_puts(const char *str) {
 
 // receive one character over UART
 char uart_getc(void) {
-    while (!(UCSR0A & (1 << RXC0))); // wait until data is received
-    return UDR0;                     // read received byte
+    uint8_t tail = rx_tail;
+    while (rx_head == tail);         // wait until data is received
+    char c = rx_buffer[tail];
+    rx_tail = (tail + 1) & UART_RX_MASK;
+#if UART_FLOW
+    rx_resume_check();
+#endif
+    return c;
+}
+
+// true if a received character is waiting in the receive buffer
+bool uart_available(void) {
+    return rx_head != rx_tail;
 }
 
 // --- Integer printing helpers ---
@@ -98,7 +386,7 @@ void uart_print_oct_width(unsigned long n, int width, char pad, bool alt) {
 
 void uart_print_ptr(void *ptr) {
     unsigned int addr = (unsigned int)ptr;
-    uart_puts("0x");
+    uart_puts(PSTR("0x"));
     uart_print_hex_width(addr, 0, '0', false);
 }
 
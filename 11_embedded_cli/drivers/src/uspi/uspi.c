@@ -0,0 +1,80 @@
+#include "uspi.h"
+#include "uart.h"
+#include "avr/io.h"
+#include "avr/gpio.h"
+
+#define XCK_PIN D, 4
+
+// UART setup to restore in uspi_end()
+static struct {
+    uint8_t ubrrh, ubrrl, ucsra, ucsrb, ucsrc;
+} saved;
+
+static bool tx_used;                // TXC0 is only meaningful after a write
+
+static inline void put(uint8_t c) {
+    while (!(UCSR0A & (1 << UDRE0)));
+    UCSR0A = (1 << TXC0);           // clear, so uspi_flush() waits for this byte
+    UDR0 = c;
+}
+
+void uspi_begin(uint16_t ubrr, uint8_t mode, bool lsb_first) {
+    uart_flush();
+    saved.ubrrh = UBRR0H;
+    saved.ubrrl = UBRR0L;
+    saved.ucsra = UCSR0A & ((1 << U2X0) | (1 << MPCM0));
+    saved.ucsrb = UCSR0B;
+    saved.ucsrc = UCSR0C;
+
+    // datasheet order: UBRR 0 and XCK output before enabling, then the rate
+    UCSR0B = 0;
+    UBRR0H = 0;
+    UBRR0L = 0;
+    gpio_output(XCK_PIN);
+    UCSR0C = (1 << UMSEL01) | (1 << UMSEL00)
+           | (lsb_first ? (1 << UDORD0) : 0)
+           | ((mode & 2) ? (1 << UCPOL0) : 0)
+           | ((mode & 1) ? (1 << UCPHA0) : 0);
+    UCSR0B = (1 << RXEN0) | (1 << TXEN0);
+    UBRR0H = (uint8_t)(ubrr >> 8);
+    UBRR0L = (uint8_t)ubrr;
+    tx_used = false;
+}
+
+void uspi_end(void) {
+    uspi_flush();
+    UCSR0B = 0;
+    gpio_input(XCK_PIN);
+
+    UBRR0H = saved.ubrrh;
+    UBRR0L = saved.ubrrl;
+    UCSR0A = saved.ucsra;
+    UCSR0C = saved.ucsrc;
+    UCSR0B = saved.ucsrb;
+}
+
+void uspi_flush(void) {
+    if (tx_used)
+        while (!(UCSR0A & (1 << TXC0)));
+    while (UCSR0A & (1 << RXC0))
+        (void)UDR0;                 // drop what came in meanwhile
+    tx_used = false;
+}
+
+uint8_t uspi_transfer(uint8_t b) {
+    uspi_flush();
+    put(b);
+    while (!(UCSR0A & (1 << RXC0)));
+    return UDR0;
+}
+
+void uspi_write(const uint8_t *data, uint16_t len) {
+    while (len--)
+        put(*data++);
+    tx_used = true;
+}
+
+void uspi_putc(char c) {
+    put((uint8_t)c);
+    tx_used = true;
+}
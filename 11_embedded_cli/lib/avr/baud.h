@@ -0,0 +1,69 @@
+#ifndef BAUD_H
+#define BAUD_H
+
+#include "config.h"
+
+// -----------------------------------------------------------------------------
+// Compile-time USART0 baud rate setup
+// -----------------------------------------------------------------------------
+// Define BAUD (and optionally BAUD_TOL) before including. Gives:
+//
+//   UBRR_VALUE  - rounded divider for UBRR0
+//   USE_U2X     - 1 if double-speed mode (U2X0 in UCSR0A) is the closer fit
+//
+// Both modes are rounded to the nearest divider and the one with the lower
+// error wins; on a tie normal mode is kept, its receiver samples each bit
+// 16 times instead of 8. At 16 MHz:
+//
+//   BAUD      mode  UBRR  error
+//   57600     U2X     34  -0.8%
+//   115200    U2X     16   2.1%  (needs BAUD_TOL 3)
+//   250000    1x       3   0
+//   500000    1x       1   0
+//   1000000   1x       0   0
+//   2000000   U2X      0   0
+//
+// Builds fail if the error is above BAUD_TOL percent (default 2) or the
+// rate cannot be reached. The error checks use the preprocessor's 64-bit
+// arithmetic and are not usable in C expressions.
+
+#ifndef F_CPU
+#error "F_CPU must be defined (config.h)"
+#endif
+#ifndef BAUD
+#error "BAUD must be defined before including baud.h"
+#endif
+#ifndef BAUD_TOL
+#define BAUD_TOL 2
+#endif
+
+// UBRR + 1 for each mode, rounded to nearest
+#define _BAUD_DIV_1X ((F_CPU + 8UL * (BAUD)) / (16UL * (BAUD)))
+#define _BAUD_DIV_2X ((F_CPU + 4UL * (BAUD)) / (8UL * (BAUD)))
+
+// |actual - BAUD| / BAUD in 1/100 percent for 'clocks' cycles per bit
+#define _BAUD_ERROR(clocks) \
+    ((F_CPU * 10000 / (clocks) > (BAUD) * 10000UL) \
+        ? (F_CPU * 10000 / (clocks) - (BAUD) * 10000UL) / (BAUD) \
+        : ((BAUD) * 10000UL - F_CPU * 10000 / (clocks)) / (BAUD))
+
+#if _BAUD_DIV_2X == 0
+#error "BAUD is above F_CPU / 8, the fastest USART rate"
+#elif _BAUD_DIV_1X > 4096
+#error "BAUD is too low for a 12-bit UBRR at this F_CPU"
+#elif _BAUD_DIV_1X == 0 || (_BAUD_DIV_2X <= 4096 && \
+      _BAUD_ERROR(8 * _BAUD_DIV_2X) < _BAUD_ERROR(16 * _BAUD_DIV_1X))
+#define USE_U2X 1
+#define UBRR_VALUE (_BAUD_DIV_2X - 1)
+#define _BAUD_ERROR_SELECTED _BAUD_ERROR(8 * _BAUD_DIV_2X)
+#else
+#define USE_U2X 0
+#define UBRR_VALUE (_BAUD_DIV_1X - 1)
+#define _BAUD_ERROR_SELECTED _BAUD_ERROR(16 * _BAUD_DIV_1X)
+#endif
+
+#if _BAUD_ERROR_SELECTED > BAUD_TOL * 100
+#error "Baud rate error above BAUD_TOL percent, change BAUD or F_CPU"
+#endif
+
+#endif // BAUD_H
@@ -0,0 +1,91 @@
+#ifndef DELAY_H
+#define DELAY_H
+
+#include "stdint.h"
+#include "config.h"
+
+// -----------------------------------------------------------------------------
+// Cycle-exact busy-wait delays
+// -----------------------------------------------------------------------------
+// delay_cycles(n) burns exactly n CPU cycles; delay_us()/delay_ms() convert
+// from F_CPU (lib/config.h) and round up, so a delay is never shorter than
+// asked for. Arguments must be compile-time constants and the code must be
+// built with optimisation (the build uses -Os): the loop counts are folded
+// into ldi immediates.
+//
+// The instruction sequences are written out in inline assembly, so the
+// timing does not depend on the compiler (avr-gcc or clang) or its flags:
+//
+//   n <= 5            nop / rjmp .+0 only (1 and 2 cycles)
+//   n <= 770          8-bit loop   ldi; 1: dec; brne 1b             3k cycles
+//   n <= 262148       16-bit loop  ldi x2; 1: sbiw; brne 1b         4k + 1
+//   larger            32-bit loop  ldi x4; 1: subi; sbci x3; brne   6k + 3
+//
+// plus up to 5 cycles of nop/rjmp padding. Interrupts that fire during a
+// delay lengthen it; wrap it in cli()/sei() when that matters.
+
+// Pad with 0..5 cycles using the fewest instructions
+static inline __attribute__((always_inline)) void _delay_pad(uint8_t n) {
+    if (n >= 4)
+        __asm__ __volatile__ ("rjmp .+0" "\n\t" "rjmp .+0");
+    else if (n >= 2)
+        __asm__ __volatile__ ("rjmp .+0");
+    if (n & 1)
+        __asm__ __volatile__ ("nop");
+}
+
+static inline __attribute__((always_inline)) void delay_cycles(uint32_t n) {
+    if (n <= 5) {
+        _delay_pad(n);
+    } else if (n <= 3UL * 256 + 2) {
+        uint16_t k = n / 3;                 // 2..256, 256 is encoded as 0
+        uint8_t r;
+        __asm__ __volatile__ (
+            "ldi  %0, %1"  "\n"
+            "1:"           "\n\t"
+            "dec  %0"      "\n\t"
+            "brne 1b"
+            : "=&d" (r)
+            : "M" (k & 0xFF)
+        );
+        _delay_pad(n - 3 * k);
+    } else if (n <= 4UL * 65536 + 1 + 3) {
+        uint32_t k = (n - 1) / 4;           // 192..65536, 65536 is encoded as 0
+        uint16_t r;
+        __asm__ __volatile__ (
+            "ldi  %A0, %1"  "\n\t"
+            "ldi  %B0, %2"  "\n"
+            "1:"            "\n\t"
+            "sbiw %0, 1"    "\n\t"
+            "brne 1b"
+            : "=&w" (r)
+            : "M" (k & 0xFF), "M" ((k >> 8) & 0xFF)
+        );
+        _delay_pad(n - (4 * k + 1));
+    } else {
+        uint32_t k = (n - 3) / 6;
+        uint32_t r;
+        __asm__ __volatile__ (
+            "ldi  %A0, %1"  "\n\t"
+            "ldi  %B0, %2"  "\n\t"
+            "ldi  %C0, %3"  "\n\t"
+            "ldi  %D0, %4"  "\n"
+            "1:"            "\n\t"
+            "subi %A0, 1"   "\n\t"
+            "sbci %B0, 0"   "\n\t"
+            "sbci %C0, 0"   "\n\t"
+            "sbci %D0, 0"   "\n\t"
+            "brne 1b"
+            : "=&d" (r)
+            : "M" (k & 0xFF), "M" ((k >> 8) & 0xFF),
+              "M" ((k >> 16) & 0xFF), "M" ((k >> 24) & 0xFF)
+        );
+        _delay_pad(n - (6 * k + 3));
+    }
+}
+
+// Microseconds / milliseconds, rounded up to whole cycles
+#define delay_us(us) delay_cycles((uint32_t)(((uint64_t)(us) * F_CPU + 999999UL) / 1000000UL))
+#define delay_ms(ms) delay_cycles((uint32_t)((uint64_t)(ms) * (F_CPU / 1000UL)))
+
+#endif // DELAY_H
@@ -0,0 +1,45 @@
+#ifndef INTERRUPT_H
+#define INTERRUPT_H
+
+#include "avr/io.h"
+
+// -----------------------------------------------------------------------------
+// Global interrupt enable
+// -----------------------------------------------------------------------------
+// The "memory" clobber keeps the compiler from moving memory accesses across
+// the instruction, so code between cli() and sei() really is atomic.
+#define sei() __asm__ __volatile__ ("sei" ::: "memory")
+#define cli() __asm__ __volatile__ ("cli" ::: "memory")
+#define reti() __asm__ __volatile__ ("reti" ::: "memory")
+
+// -----------------------------------------------------------------------------
+// Interrupt service routines
+// -----------------------------------------------------------------------------
+// Define a handler for one of the *_vect names from avr/io.h:
+//
+//   ISR(USART_RX_vect) {
+//       rx_byte = UDR0;
+//   }
+//
+// The handler replaces the weak __vector_n alias in crt0.S, so the vector
+// table picks it up at link time. An optional attribute changes how the
+// handler is entered:
+//
+//   ISR_BLOCK    - default; interrupts stay disabled until reti
+//   ISR_NOBLOCK  - re-enables interrupts with sei as the first instruction,
+//                  so higher priority work is not held up by this handler
+//   ISR_NAKED    - no prologue/epilogue at all; the body must save whatever
+//                  it touches (including SREG) and end with reti()
+//   ISR_ALIASOF(v) - share the handler of another vector
+#define ISR_BLOCK
+#define ISR_NOBLOCK    __attribute__((interrupt))
+#define ISR_NAKED      __attribute__((naked))
+#define ISR_ALIASOF(v) __attribute__((alias(__STRINGIFY(v))))
+
+#define __STRINGIFY(x) #x
+
+#define ISR(vector, ...)                                                        \
+    void vector(void) __attribute__((signal, used, externally_visible)) __VA_ARGS__; \
+    void vector(void)
+
+#endif // INTERRUPT_H
@@ -1,7 +1,12 @@
 #ifndef IO_H
 #define IO_H
 
+// This header is also included from assembly (crt0.S). The C-only parts are
+// guarded by __ASSEMBLER__; there the register macros expand to plain
+// addresses for use with _SFR_IO_ADDR() / lds / sts.
+#ifndef __ASSEMBLER__
 #include "stdint.h"  // Include standard integer types for fixed width integers
+#endif
 
 // -----------------------------------------------------------------------------
 // Register I/O macros
@@ -15,8 +20,27 @@
 // Usage example:
 //   uint8_t port_value = PORTB;  // Read the PORTB register
 //   PORTB = 0xFF;                // Write to PORTB register
+#ifndef __ASSEMBLER__
 #define _SFR_IO8(addr) (*(volatile uint8_t *)(addr))
 
+// Same for 16-bit register pairs (e.g. TCNT1). avr-gcc accesses the low byte
+// first on reads and the high byte first on writes, as the hardware's shared
+// TEMP register requires.
+#define _SFR_MEM16(addr) (*(volatile uint16_t *)(addr))
+
+// I/O space address of a register, for in/out/sbi/cbi in inline assembly:
+//   __asm__ ("sbi %0, %1" :: "I" (_SFR_IO_ADDR(PORTB)), "I" (PB5));
+#define _SFR_IO_ADDR(sfr) ((uint16_t)&(sfr) - 0x20)
+
+// Data space address of a register, for lds/sts in inline assembly
+#define _SFR_MEM_ADDR(sfr) ((uint16_t)&(sfr))
+#else
+#define _SFR_IO8(addr) (addr)
+#define _SFR_MEM16(addr) (addr)
+#define _SFR_IO_ADDR(sfr) ((sfr) - 0x20)
+#define _SFR_MEM_ADDR(sfr) (sfr)
+#endif
+
 // -----------------------------------------------------------------------------
 // ATmega328P I/O register base addresses
 // -----------------------------------------------------------------------------
@@ -129,6 +153,10 @@
 #define UCSZ00  1   // Character Size bit 0
 #define UCPOL0  0   // Clock Polarity
 
+// UCSR0C bits in master SPI mode (UMSEL01:0 = 11); XCK0 (PD4) is SCK
+#define UDORD0  2   // Data Order, 1 = LSB first
+#define UCPHA0  1   // Clock Phase
+
 // ---- Registers ----
 #define UBRR0H   (*(volatile uint8_t*)0xC5)
 #define UBRR0L   (*(volatile uint8_t*)0xC4)
@@ -148,4 +176,300 @@
 #define UCSZ00   1
 
 
+// -----------------------------------------------------------------------------
+// General Purpose I/O Registers
+// -----------------------------------------------------------------------------
+// Free for application use. GPIOR0 sits in the low I/O space, so single bits
+// can be set, cleared and tested with sbi/cbi/sbic/sbis without touching any
+// CPU register or SREG. GPIOR1/GPIOR2 are only reachable with in/out.
+#define GPIOR0   _SFR_IO8(0x3E)
+#define GPIOR1   _SFR_IO8(0x4A)
+#define GPIOR2   _SFR_IO8(0x4B)
+
+// -----------------------------------------------------------------------------
+// Timer/Counter0 (8-bit)
+// -----------------------------------------------------------------------------
+#define TIFR0    _SFR_IO8(0x35)   // Interrupt Flag Register
+#define TCCR0A   _SFR_IO8(0x44)   // Control Register A
+#define TCCR0B   _SFR_IO8(0x45)   // Control Register B
+#define TCNT0    _SFR_IO8(0x46)   // Counter value
+#define OCR0A    _SFR_IO8(0x47)   // Output Compare Register A
+#define OCR0B    _SFR_IO8(0x48)   // Output Compare Register B
+#define TIMSK0   _SFR_IO8(0x6E)   // Interrupt Mask Register
+
+// TCCR0A bits
+#define WGM01   1   // Waveform Generation Mode bit 1 (CTC)
+#define WGM00   0
+
+// TCCR0B bits
+#define CS02    2   // Clock Select bits
+#define CS01    1
+#define CS00    0
+
+// TIFR0 / TIMSK0 bits
+#define OCF0B   2
+#define OCF0A   1
+#define TOV0    0
+#define OCIE0B  2
+#define OCIE0A  1
+#define TOIE0   0
+
+// -----------------------------------------------------------------------------
+// Timer/Counter2 (8-bit, asynchronous capable)
+// -----------------------------------------------------------------------------
+#define TIFR2    _SFR_IO8(0x37)   // Interrupt Flag Register
+#define TIMSK2   _SFR_IO8(0x70)   // Interrupt Mask Register
+#define TCCR2A   _SFR_IO8(0xB0)   // Control Register A
+#define TCCR2B   _SFR_IO8(0xB1)   // Control Register B
+#define TCNT2    _SFR_IO8(0xB2)   // Counter value
+#define OCR2A    _SFR_IO8(0xB3)   // Output Compare Register A
+#define OCR2B    _SFR_IO8(0xB4)   // Output Compare Register B
+
+// TCCR2A bits
+#define WGM21   1   // Waveform Generation Mode bit 1 (CTC)
+#define WGM20   0
+
+// TCCR2B bits
+#define CS22    2   // Clock Select bits
+#define CS21    1
+#define CS20    0
+
+// TIFR2 / TIMSK2 bits
+#define OCF2B   2
+#define OCF2A   1
+#define TOV2    0
+#define OCIE2B  2
+#define OCIE2A  1
+#define TOIE2   0
+
+// -----------------------------------------------------------------------------
+// Timer/Counter1 (16-bit)
+// -----------------------------------------------------------------------------
+#define TIFR1    _SFR_IO8(0x36)   // Interrupt Flag Register
+#define TIMSK1   _SFR_IO8(0x6F)   // Interrupt Mask Register
+#define TCCR1A   _SFR_IO8(0x80)   // Control Register A
+#define TCCR1B   _SFR_IO8(0x81)   // Control Register B
+#define TCCR1C   _SFR_IO8(0x82)   // Control Register C
+#define TCNT1    _SFR_MEM16(0x84) // Counter value
+#define TCNT1L   _SFR_IO8(0x84)   // Counter low byte (read first)
+#define TCNT1H   _SFR_IO8(0x85)   // Counter high byte
+#define ICR1     _SFR_MEM16(0x86) // Input Capture Register
+#define OCR1A    _SFR_MEM16(0x88) // Output Compare Register A
+#define OCR1B    _SFR_MEM16(0x8A) // Output Compare Register B
+
+// TCCR1B bits
+#define ICNC1   7   // Input Capture Noise Canceler
+#define ICES1   6   // Input Capture Edge Select
+#define WGM13   4   // Waveform Generation Mode bit 3
+#define WGM12   3   // Waveform Generation Mode bit 2
+#define CS12    2   // Clock Select bits
+#define CS11    1
+#define CS10    0
+
+// TIFR1 / TIMSK1 bits
+#define ICF1    5   // Input Capture Flag
+#define OCF1B   2   // Output Compare B Match Flag
+#define OCF1A   1   // Output Compare A Match Flag
+#define TOV1    0   // Overflow Flag
+#define ICIE1   5   // Input Capture Interrupt Enable
+#define OCIE1B  2   // Output Compare B Match Interrupt Enable
+#define OCIE1A  1   // Output Compare A Match Interrupt Enable
+#define TOIE1   0   // Overflow Interrupt Enable
+
+// -----------------------------------------------------------------------------
+// Analog-to-Digital Converter
+// -----------------------------------------------------------------------------
+#define ADCL     _SFR_IO8(0x78)   // Data Register, low byte (read first)
+#define ADCH     _SFR_IO8(0x79)   // Data Register, high byte
+#define ADCW     _SFR_MEM16(0x78) // Data Register as one 16-bit read
+#define ADCSRA   _SFR_IO8(0x7A)   // Control and Status Register A
+#define ADCSRB   _SFR_IO8(0x7B)   // Control and Status Register B
+#define ADMUX    _SFR_IO8(0x7C)   // Multiplexer Selection Register
+#define DIDR0    _SFR_IO8(0x7E)   // Digital Input Disable Register 0
+
+// ADMUX bits
+#define REFS1   7   // Reference Selection bits
+#define REFS0   6
+#define ADLAR   5   // Left Adjust Result
+#define MUX3    3   // Channel Selection bits
+#define MUX2    2
+#define MUX1    1
+#define MUX0    0
+
+// ADCSRA bits
+#define ADEN    7   // ADC Enable
+#define ADSC    6   // Start Conversion
+#define ADATE   5   // Auto Trigger Enable
+#define ADIF    4   // Interrupt Flag
+#define ADIE    3   // Interrupt Enable
+#define ADPS2   2   // Prescaler Select bits
+#define ADPS1   1
+#define ADPS0   0
+
+// ADCSRB bits
+#define ADTS2   2   // Auto Trigger Source bits
+#define ADTS1   1
+#define ADTS0   0
+
+// -----------------------------------------------------------------------------
+// Serial Peripheral Interface
+// -----------------------------------------------------------------------------
+// Pins: SS PB2, MOSI PB3, MISO PB4, SCK PB5. SS must be an output (or held
+// high) for the SPI to stay master.
+#define SPCR     _SFR_IO8(0x4C)   // Control Register
+#define SPSR     _SFR_IO8(0x4D)   // Status Register
+#define SPDR     _SFR_IO8(0x4E)   // Data Register
+
+// SPCR bits
+#define SPIE    7   // Interrupt Enable
+#define SPE     6   // SPI Enable
+#define DORD    5   // Data Order, 1 = LSB first
+#define MSTR    4   // Master Select
+#define CPOL    3   // Clock Polarity
+#define CPHA    2   // Clock Phase
+#define SPR1    1   // Clock Rate Select bits
+#define SPR0    0
+
+// SPSR bits
+#define SPIF    7   // Interrupt Flag
+#define WCOL    6   // Write Collision Flag
+#define SPI2X   0   // Double SPI Speed
+
+// -----------------------------------------------------------------------------
+// 2-wire Serial Interface (TWI / I2C)
+// -----------------------------------------------------------------------------
+// Pins: SDA PC4, SCL PC5. SCL = F_CPU / (16 + 2 * TWBR * prescaler).
+#define TWBR     _SFR_IO8(0xB8)   // Bit Rate Register
+#define TWSR     _SFR_IO8(0xB9)   // Status Register (status in bits 7..3)
+#define TWAR     _SFR_IO8(0xBA)   // (Slave) Address Register
+#define TWDR     _SFR_IO8(0xBB)   // Data Register
+#define TWCR     _SFR_IO8(0xBC)   // Control Register
+#define TWAMR    _SFR_IO8(0xBD)   // (Slave) Address Mask Register
+
+// TWCR bits
+#define TWINT   7   // Interrupt Flag, write 1 to start the next step
+#define TWEA    6   // Enable Acknowledge
+#define TWSTA   5   // START Condition
+#define TWSTO   4   // STOP Condition, cleared when it has been sent
+#define TWWC    3   // Write Collision Flag
+#define TWEN    2   // TWI Enable
+#define TWIE    0   // Interrupt Enable
+
+// TWSR bits
+#define TWPS1   1   // Prescaler bits
+#define TWPS0   0
+
+// -----------------------------------------------------------------------------
+// EEPROM (1 KB)
+// -----------------------------------------------------------------------------
+// EECR, EEDR and EEARL sit in the low I/O space (sbi/cbi reachable), which
+// the timed EEMPE -> EEPE write sequence relies on.
+#define EECR     _SFR_IO8(0x3F)   // Control Register
+#define EEDR     _SFR_IO8(0x40)   // Data Register
+#define EEAR     _SFR_MEM16(0x41) // Address Register
+#define EEARL    _SFR_IO8(0x41)   // Address low byte
+#define EEARH    _SFR_IO8(0x42)   // Address high byte
+
+#define E2END    0x3FF            // last EEPROM address
+
+// EECR bits
+#define EEPM1   5   // Programming Mode: 00 erase + write, 01 erase only,
+#define EEPM0   4   //                   10 write only
+#define EERIE   3   // Ready Interrupt Enable (fires while EEPE is clear)
+#define EEMPE   2   // Master Write Enable, EEPE must follow within 4 cycles
+#define EEPE    1   // Write Enable, cleared when the write has finished
+#define EERE    0   // Read Enable
+
+// -----------------------------------------------------------------------------
+// CPU core: stack pointer and status register
+// -----------------------------------------------------------------------------
+#define SPL      _SFR_IO8(0x5D)   // Stack Pointer, low byte
+#define SPH      _SFR_IO8(0x5E)   // Stack Pointer, high byte
+#define SREG     _SFR_IO8(0x5F)   // Status Register
+
+#define SREG_I  7   // Global Interrupt Enable
+
+// -----------------------------------------------------------------------------
+// Reset status and watchdog timer
+// -----------------------------------------------------------------------------
+#define MCUSR    _SFR_IO8(0x54)   // MCU Status Register (reset cause)
+#define WDTCSR   _SFR_IO8(0x60)   // Watchdog Timer Control Register
+
+// MCUSR bits
+#define WDRF    3   // Watchdog Reset Flag
+#define BORF    2   // Brown-out Reset Flag
+#define EXTRF   1   // External Reset Flag
+#define PORF    0   // Power-on Reset Flag
+
+// WDTCSR bits
+#define WDIF    7   // Watchdog Interrupt Flag
+#define WDIE    6   // Watchdog Interrupt Enable
+#define WDP3    5   // Prescaler bit 3
+#define WDCE    4   // Change Enable
+#define WDE     3   // System Reset Enable
+#define WDP2    2   // Prescaler bits 2..0
+#define WDP1    1
+#define WDP0    0
+
+// -----------------------------------------------------------------------------
+// Interrupt vectors
+// -----------------------------------------------------------------------------
+// Vector numbers from the datasheet ("Reset and Interrupt Vectors"). crt0.S
+// builds the table from _VECTORS_SIZE and ISR() (see avr/interrupt.h) turns
+// a name such as USART_RX_vect into the handler symbol __vector_18.
+#define _VECTOR(N) __vector_ ## N
+
+#define INT0_vect_num          1
+#define INT0_vect              _VECTOR(1)    // External Interrupt Request 0
+#define INT1_vect_num          2
+#define INT1_vect              _VECTOR(2)    // External Interrupt Request 1
+#define PCINT0_vect_num        3
+#define PCINT0_vect            _VECTOR(3)    // Pin Change Interrupt Request 0
+#define PCINT1_vect_num        4
+#define PCINT1_vect            _VECTOR(4)    // Pin Change Interrupt Request 1
+#define PCINT2_vect_num        5
+#define PCINT2_vect            _VECTOR(5)    // Pin Change Interrupt Request 2
+#define WDT_vect_num           6
+#define WDT_vect               _VECTOR(6)    // Watchdog Time-out Interrupt
+#define TIMER2_COMPA_vect_num  7
+#define TIMER2_COMPA_vect      _VECTOR(7)    // Timer/Counter2 Compare Match A
+#define TIMER2_COMPB_vect_num  8
+#define TIMER2_COMPB_vect      _VECTOR(8)    // Timer/Counter2 Compare Match B
+#define TIMER2_OVF_vect_num    9
+#define TIMER2_OVF_vect        _VECTOR(9)    // Timer/Counter2 Overflow
+#define TIMER1_CAPT_vect_num   10
+#define TIMER1_CAPT_vect       _VECTOR(10)   // Timer/Counter1 Capture Event
+#define TIMER1_COMPA_vect_num  11
+#define TIMER1_COMPA_vect      _VECTOR(11)   // Timer/Counter1 Compare Match A
+#define TIMER1_COMPB_vect_num  12
+#define TIMER1_COMPB_vect      _VECTOR(12)   // Timer/Counter1 Compare Match B
+#define TIMER1_OVF_vect_num    13
+#define TIMER1_OVF_vect        _VECTOR(13)   // Timer/Counter1 Overflow
+#define TIMER0_COMPA_vect_num  14
+#define TIMER0_COMPA_vect      _VECTOR(14)   // Timer/Counter0 Compare Match A
+#define TIMER0_COMPB_vect_num  15
+#define TIMER0_COMPB_vect      _VECTOR(15)   // Timer/Counter0 Compare Match B
+#define TIMER0_OVF_vect_num    16
+#define TIMER0_OVF_vect        _VECTOR(16)   // Timer/Counter0 Overflow
+#define SPI_STC_vect_num       17
+#define SPI_STC_vect           _VECTOR(17)   // SPI Serial Transfer Complete
+#define USART_RX_vect_num      18
+#define USART_RX_vect          _VECTOR(18)   // USART Rx Complete
+#define USART_UDRE_vect_num    19
+#define USART_UDRE_vect        _VECTOR(19)   // USART Data Register Empty
+#define USART_TX_vect_num      20
+#define USART_TX_vect          _VECTOR(20)   // USART Tx Complete
+#define ADC_vect_num           21
+#define ADC_vect               _VECTOR(21)   // ADC Conversion Complete
+#define EE_READY_vect_num      22
+#define EE_READY_vect          _VECTOR(22)   // EEPROM Ready
+#define ANALOG_COMP_vect_num   23
+#define ANALOG_COMP_vect       _VECTOR(23)   // Analog Comparator
+#define TWI_vect_num           24
+#define TWI_vect               _VECTOR(24)   // 2-wire Serial Interface
+#define SPM_READY_vect_num     25
+#define SPM_READY_vect         _VECTOR(25)   // Store Program Memory Ready
+
+#define _VECTORS_SIZE          (26 * 4)      // 26 two-word (JMP) slots
+
 #endif // IO_H
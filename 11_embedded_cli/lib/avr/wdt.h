@@ -0,0 +1,65 @@
+#ifndef WDT_H
+#define WDT_H
+
+#include "avr/io.h"
+#include "stdint.h"
+
+// -----------------------------------------------------------------------------
+// Watchdog timer
+// -----------------------------------------------------------------------------
+// The watchdog runs from its own 128 kHz oscillator. Changing WDE or the
+// prescaler needs the timed sequence: write WDCE|WDE, then the new value
+// within 4 cycles, so both stores are in one asm block with interrupts off.
+//
+//   wdt_enable(WDTO_1S)      - reset after 1 s without wdt_reset()
+//   wdt_enable_irq(WDTO_1S)  - WDT_vect first (WDIE is then cleared by
+//                              hardware), reset on the next timeout
+//
+// After a watchdog reset WDRF in MCUSR keeps the watchdog running at the
+// shortest timeout; crt0 clears it before anything else.
+
+#define WDTO_15MS   0
+#define WDTO_30MS   1
+#define WDTO_60MS   2
+#define WDTO_120MS  3
+#define WDTO_250MS  4
+#define WDTO_500MS  5
+#define WDTO_1S     6
+#define WDTO_2S     7
+#define WDTO_4S     8
+#define WDTO_8S     9
+
+// WDTCSR prescaler bits for a WDTO_* value (WDP3 is not next to WDP2..0)
+#define _WDT_PRESCALER(value) ((((value) & 0x08) ? (1 << WDP3) : 0) | ((value) & 0x07))
+
+#define wdt_reset() __asm__ __volatile__ ("wdr")
+
+static inline __attribute__((always_inline)) void _wdt_write(uint8_t value) {
+    uint8_t sreg = SREG;
+    __asm__ __volatile__ (
+        "cli"           "\n\t"
+        "wdr"           "\n\t"
+        "sts %0, %1"    "\n\t"
+        "sts %0, %2"
+        :
+        : "n" (_SFR_MEM_ADDR(WDTCSR)),
+          "r" ((uint8_t)((1 << WDCE) | (1 << WDE))),
+          "r" (value)
+        : "memory"
+    );
+    SREG = sreg;
+}
+
+static inline __attribute__((always_inline)) void wdt_enable(uint8_t timeout) {
+    _wdt_write((1 << WDE) | _WDT_PRESCALER(timeout));
+}
+
+static inline __attribute__((always_inline)) void wdt_enable_irq(uint8_t timeout) {
+    _wdt_write((1 << WDIE) | (1 << WDE) | _WDT_PRESCALER(timeout));
+}
+
+static inline __attribute__((always_inline)) void wdt_disable(void) {
+    _wdt_write(0);
+}
+
+#endif // WDT_H
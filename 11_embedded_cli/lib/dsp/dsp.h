@@ -0,0 +1,121 @@
+#ifndef DSP_H
+#define DSP_H
+
+#include "stdint.h"
+#include "fixmath.h"
+
+// -----------------------------------------------------------------------------
+// Fixed-point filters and FFT for sample streams
+// -----------------------------------------------------------------------------
+// Samples are Q1.15 (int16_t). Convert ADC counts first, e.g. a 10-bit
+// reading to a signed sample around mid-scale: (int16_t)(value - 512) << 5.
+//
+// Products come from the hardware multiplier (fix_macs16x16_32) and are
+// summed at full precision in a 32-bit accumulator; the result is rounded
+// and saturated once per output sample, so the only rounding noise is
+// half an LSB at the output.
+//
+// Coefficients live in flash (PROGMEM) and are usually generated at build
+// time by tools/gen_filters.py from src/filters.json (filter_coeffs.h).
+// Filter state lives in caller-provided SRAM, so one coefficient table can
+// drive any number of channels.
+//
+//   static int16_t delay[LOWPASS_FIR_TAPS];
+//   dsp_fir_t fir;
+//   dsp_fir_init(&fir, lowpass_fir, delay, LOWPASS_FIR_TAPS);
+//   dsp_fir_block(&fir, in, out, n);
+
+// --- FIR ---
+
+// y = sum(taps[k] * x[n - k]), taps in Q1.15. The sum of |taps| must stay
+// below 2 (one guard bit in the accumulator); a unity-gain lowpass is well
+// within that.
+typedef struct {
+    const q15_t *taps;              // ntaps coefficients in flash
+    int16_t *delay;                 // ntaps samples of history
+    uint8_t ntaps;
+    uint8_t pos;                    // newest sample; older ones follow it
+} dsp_fir_t;
+
+void dsp_fir_init(dsp_fir_t *fir, const q15_t *taps, int16_t *delay, uint8_t ntaps);
+
+// Clear the history (silence)
+void dsp_fir_reset(dsp_fir_t *fir);
+
+int16_t dsp_fir(dsp_fir_t *fir, int16_t x);
+
+// Filter n samples; 'out' may be 'in'
+void dsp_fir_block(dsp_fir_t *fir, const int16_t *in, int16_t *out, uint16_t n);
+
+// --- Biquad IIR ---
+
+// Coefficients in Q2.14 (-2 .. 2), normalised to a0 = 1, with a1 and a2
+// negated so every term is a multiply-add:
+//   y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2]
+#define DSP_BIQUAD_SHIFT 14
+
+typedef struct {
+    int16_t b0, b1, b2, a1, a2;
+} dsp_biquad_coeffs_t;
+
+// Direct form I: the state is plain input and output samples, so the
+// 32-bit sum has no internal node that can overflow
+typedef struct {
+    int16_t x1, x2, y1, y2;
+} dsp_biquad_state_t;
+
+// A cascade of second-order sections, run in order
+typedef struct {
+    const dsp_biquad_coeffs_t *coeffs;  // 'sections' sets in flash
+    dsp_biquad_state_t *state;          // 'sections' entries
+    uint8_t sections;
+} dsp_biquad_t;
+
+void dsp_biquad_init(dsp_biquad_t *iir, const dsp_biquad_coeffs_t *coeffs,
+                     dsp_biquad_state_t *state, uint8_t sections);
+
+void dsp_biquad_reset(dsp_biquad_t *iir);
+
+int16_t dsp_biquad(dsp_biquad_t *iir, int16_t x);
+
+// Filter n samples one section at a time, so each section's coefficients
+// and state are loaded once per block; 'out' may be 'in'
+void dsp_biquad_block(dsp_biquad_t *iir, const int16_t *in, int16_t *out, uint16_t n);
+
+// --- FFT ---
+
+// Radix-2 decimation-in-time FFT in place on complex Q1.15 samples stored
+// interleaved (re, im, re, im, ...), 2^bits points, up to
+// DSP_FFT_MAX_POINTS. Twiddles and the bit-reversal order come from flash
+// tables.
+//
+// Block scaling: a stage whose inputs reach 1/4 of full scale halves its
+// outputs, so nothing overflows whatever the input, while small signals
+// keep their resolution. The return value is the number of halvings, the
+// block exponent: the DFT is the output times 2^exponent. -1 if 'bits' is
+// out of range.
+#define DSP_FFT_MAX_BITS   8
+#define DSP_FFT_MAX_POINTS (1 << DSP_FFT_MAX_BITS)
+
+int8_t dsp_fft(int16_t *data, uint8_t bits);
+
+// FFT of 2^bits real samples in place, computed as a complex FFT of half
+// the size plus a split pass, so 256 points take 512 bytes. The output
+// holds bins 0 .. N/2: data[0] is bin 0 (DC) and data[1] bin N/2 (both
+// real), then re, im of bins 1 .. N/2 - 1. Returns the block exponent as
+// dsp_fft() does; 'bits' is 2 .. DSP_FFT_MAX_BITS.
+int8_t dsp_fft_real(int16_t *data, uint8_t bits);
+
+// |re + j im| of 'bins' interleaved values without a square root:
+// max(M, 7/8 M + 1/2 m), M and m the larger and smaller of |re| and |im|,
+// within 3% of the true magnitude. 'mag' may be 'data' (bin k lands on
+// value k, already read). For dsp_fft_real() output, mag[0] mixes bins 0
+// and N/2; use data[0] and data[1] for those.
+void dsp_fft_magnitude(const int16_t *data, uint16_t *mag, uint16_t bins);
+
+// Room for the largest transform, shared by the callers (the fft command,
+// bench fft), which never run at the same time. Static rather than on the
+// stack so its 512 bytes are counted in .bss and checked by the link.
+extern int16_t dsp_fft_buffer[DSP_FFT_MAX_POINTS];
+
+#endif // DSP_H
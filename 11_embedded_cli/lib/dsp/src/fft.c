@@ -0,0 +1,231 @@
+#include "dsp.h"
+#include "pgmspace.h"
+#include "stdbool.h"
+
+// |x| >= 8192: a butterfly could more than double it, so the stage halves
+#define SCALE_MASK      0xE000
+// |x| >= 16384 on input: halved once first, keeping every complex value
+// below 16384 * sqrt(2) = 23170, which a halving stage never exceeds
+#define PRESCALE_MASK   0xC000
+#define ROUND           0x4000L
+
+int16_t dsp_fft_buffer[DSP_FFT_MAX_POINTS];
+
+// cos and sin of 2 pi k / 256 in Q1.15, k = 0..127 (1.0 as 32767)
+static const int16_t twiddle[DSP_FFT_MAX_POINTS / 2][2] PROGMEM = {
+    {  32767,      0 }, {  32758,    804 }, {  32729,   1608 }, {  32679,   2411 },
+    {  32610,   3212 }, {  32522,   4011 }, {  32413,   4808 }, {  32286,   5602 },
+    {  32138,   6393 }, {  31972,   7180 }, {  31786,   7962 }, {  31581,   8740 },
+    {  31357,   9512 }, {  31114,  10279 }, {  30853,  11039 }, {  30572,  11793 },
+    {  30274,  12540 }, {  29957,  13279 }, {  29622,  14010 }, {  29269,  14733 },
+    {  28899,  15447 }, {  28511,  16151 }, {  28106,  16846 }, {  27684,  17531 },
+    {  27246,  18205 }, {  26791,  18868 }, {  26320,  19520 }, {  25833,  20160 },
+    {  25330,  20788 }, {  24812,  21403 }, {  24279,  22006 }, {  23732,  22595 },
+    {  23170,  23170 }, {  22595,  23732 }, {  22006,  24279 }, {  21403,  24812 },
+    {  20788,  25330 }, {  20160,  25833 }, {  19520,  26320 }, {  18868,  26791 },
+    {  18205,  27246 }, {  17531,  27684 }, {  16846,  28106 }, {  16151,  28511 },
+    {  15447,  28899 }, {  14733,  29269 }, {  14010,  29622 }, {  13279,  29957 },
+    {  12540,  30274 }, {  11793,  30572 }, {  11039,  30853 }, {  10279,  31114 },
+    {   9512,  31357 }, {   8740,  31581 }, {   7962,  31786 }, {   7180,  31972 },
+    {   6393,  32138 }, {   5602,  32286 }, {   4808,  32413 }, {   4011,  32522 },
+    {   3212,  32610 }, {   2411,  32679 }, {   1608,  32729 }, {    804,  32758 },
+    {      0,  32767 }, {   -804,  32758 }, {  -1608,  32729 }, {  -2411,  32679 },
+    {  -3212,  32610 }, {  -4011,  32522 }, {  -4808,  32413 }, {  -5602,  32286 },
+    {  -6393,  32138 }, {  -7180,  31972 }, {  -7962,  31786 }, {  -8740,  31581 },
+    {  -9512,  31357 }, { -10279,  31114 }, { -11039,  30853 }, { -11793,  30572 },
+    { -12540,  30274 }, { -13279,  29957 }, { -14010,  29622 }, { -14733,  29269 },
+    { -15447,  28899 }, { -16151,  28511 }, { -16846,  28106 }, { -17531,  27684 },
+    { -18205,  27246 }, { -18868,  26791 }, { -19520,  26320 }, { -20160,  25833 },
+    { -20788,  25330 }, { -21403,  24812 }, { -22006,  24279 }, { -22595,  23732 },
+    { -23170,  23170 }, { -23732,  22595 }, { -24279,  22006 }, { -24812,  21403 },
+    { -25330,  20788 }, { -25833,  20160 }, { -26320,  19520 }, { -26791,  18868 },
+    { -27246,  18205 }, { -27684,  17531 }, { -28106,  16846 }, { -28511,  16151 },
+    { -28899,  15447 }, { -29269,  14733 }, { -29622,  14010 }, { -29957,  13279 },
+    { -30274,  12540 }, { -30572,  11793 }, { -30853,  11039 }, { -31114,  10279 },
+    { -31357,   9512 }, { -31581,   8740 }, { -31786,   7962 }, { -31972,   7180 },
+    { -32138,   6393 }, { -32286,   5602 }, { -32413,   4808 }, { -32522,   4011 },
+    { -32610,   3212 }, { -32679,   2411 }, { -32729,   1608 }, { -32758,    804 }
+};
+
+// i with its 8 bits reversed
+static const uint8_t bit_reverse[DSP_FFT_MAX_POINTS] PROGMEM = {
+      0, 128,  64, 192,  32, 160,  96, 224,  16, 144,  80, 208,  48, 176, 112, 240,
+      8, 136,  72, 200,  40, 168, 104, 232,  24, 152,  88, 216,  56, 184, 120, 248,
+      4, 132,  68, 196,  36, 164, 100, 228,  20, 148,  84, 212,  52, 180, 116, 244,
+     12, 140,  76, 204,  44, 172, 108, 236,  28, 156,  92, 220,  60, 188, 124, 252,
+      2, 130,  66, 194,  34, 162,  98, 226,  18, 146,  82, 210,  50, 178, 114, 242,
+     10, 138,  74, 202,  42, 170, 106, 234,  26, 154,  90, 218,  58, 186, 122, 250,
+      6, 134,  70, 198,  38, 166, 102, 230,  22, 150,  86, 214,  54, 182, 118, 246,
+     14, 142,  78, 206,  46, 174, 110, 238,  30, 158,  94, 222,  62, 190, 126, 254,
+      1, 129,  65, 193,  33, 161,  97, 225,  17, 145,  81, 209,  49, 177, 113, 241,
+      9, 137,  73, 201,  41, 169, 105, 233,  25, 153,  89, 217,  57, 185, 121, 249,
+      5, 133,  69, 197,  37, 165, 101, 229,  21, 149,  85, 213,  53, 181, 117, 245,
+     13, 141,  77, 205,  45, 173, 109, 237,  29, 157,  93, 221,  61, 189, 125, 253,
+      3, 131,  67, 195,  35, 163,  99, 227,  19, 147,  83, 211,  51, 179, 115, 243,
+     11, 139,  75, 203,  43, 171, 107, 235,  27, 155,  91, 219,  59, 187, 123, 251,
+      7, 135,  71, 199,  39, 167, 103, 231,  23, 151,  87, 215,  55, 183, 119, 247,
+     15, 143,  79, 207,  47, 175, 111, 239,  31, 159,  95, 223,  63, 191, 127, 255
+};
+
+static inline uint16_t abs16(int16_t v) {
+    return (v < 0) ? -(uint16_t)v : (uint16_t)v;
+}
+
+// OR of the absolute values: its top bit is the top bit of the largest,
+// which is all the scaling decision needs, for one OR per value
+static uint16_t peak_bits(const int16_t *data, uint16_t count) {
+    uint16_t peak = 0;
+    while (count--)
+        peak |= abs16(*data++);
+    return peak;
+}
+
+static void reorder(int16_t *data, uint8_t bits) {
+    uint16_t n = 1 << bits;
+    uint8_t shift = DSP_FFT_MAX_BITS - bits;
+    for (uint16_t i = 0; i < n; i++) {
+        uint16_t j = pgm_read_byte(&bit_reverse[i]) >> shift;
+        if (j > i) {
+            int16_t *a = &data[2 * i];
+            int16_t *b = &data[2 * j];
+            int16_t t = a[0];
+            a[0] = b[0];
+            b[0] = t;
+            t = a[1];
+            a[1] = b[1];
+            b[1] = t;
+        }
+    }
+}
+
+// Complex FFT of 2^bits points; returns the exponent and leaves the peak
+// bits of the output in *peak_out
+static uint8_t transform(int16_t *data, uint8_t bits, uint16_t *peak_out) {
+    uint16_t n = 1 << bits;
+    uint8_t exponent = 0;
+
+    uint16_t peak = peak_bits(data, 2 * n);
+    if (peak & PRESCALE_MASK) {
+        for (uint16_t i = 0; i < 2 * n; i++)
+            data[i] >>= 1;
+        peak = peak_bits(data, 2 * n);
+        exponent++;
+    }
+    reorder(data, bits);
+
+    for (uint8_t stage = 0; stage < bits; stage++) {
+        uint16_t half = 1 << stage;
+        uint8_t stride = (DSP_FFT_MAX_POINTS / 2) >> stage;    // twiddle step
+        bool scale = peak & SCALE_MASK;
+        if (scale)
+            exponent++;
+        peak = 0;
+
+        for (uint16_t j = 0; j < half; j++) {
+            int16_t c = pgm_read_word(&twiddle[j * stride][0]);
+            int16_t s = pgm_read_word(&twiddle[j * stride][1]);
+
+            for (uint16_t i = j; i < n; i += 2 * half) {
+                int16_t *a = &data[2 * i];
+                int16_t *b = &data[2 * (i + half)];
+                int32_t tr, ti;
+
+                // t = b * (c - j s); the first twiddle is exactly 1
+                if (j == 0) {
+                    tr = b[0];
+                    ti = b[1];
+                } else {
+                    tr = fix_macs16x16_32(fix_macs16x16_32(ROUND, b[0], c), b[1], s) >> 15;
+                    ti = fix_macs16x16_32(fix_macs16x16_32(ROUND, b[1], c), b[0], -s) >> 15;
+                }
+
+                int32_t xr = a[0] + tr, xi = a[1] + ti;
+                int32_t yr = a[0] - tr, yi = a[1] - ti;
+                if (scale) {
+                    xr >>= 1;
+                    xi >>= 1;
+                    yr >>= 1;
+                    yi >>= 1;
+                }
+                a[0] = xr;
+                a[1] = xi;
+                b[0] = yr;
+                b[1] = yi;
+                peak |= abs16(xr) | abs16(xi) | abs16(yr) | abs16(yi);
+            }
+        }
+    }
+
+    *peak_out = peak;
+    return exponent;
+}
+
+int8_t dsp_fft(int16_t *data, uint8_t bits) {
+    uint16_t peak;
+    if (bits < 1 || bits > DSP_FFT_MAX_BITS)
+        return -1;
+    return transform(data, bits, &peak);
+}
+
+// The N real samples are taken as N/2 complex ones z[n] = x[2n] + j x[2n+1].
+// With Z = FFT(z), for k and m = N/2 - k:
+//   E = (Z[k] + conj(Z[m])) / 2,  O = (Z[k] - conj(Z[m])) / 2j
+//   X[k] = E + W^k O,  X[m] = conj(E - W^k O),  W = e^(-j 2 pi / N)
+int8_t dsp_fft_real(int16_t *data, uint8_t bits) {
+    uint16_t peak;
+    if (bits < 2 || bits > DSP_FFT_MAX_BITS)
+        return -1;
+
+    uint8_t exponent = transform(data, bits - 1, &peak);
+    uint16_t half = 1 << (bits - 1);
+    uint8_t stride = DSP_FFT_MAX_POINTS >> bits;
+    // |X| <= |Z[k]| + |Z[m]|: the same rule as a butterfly stage
+    bool scale = peak & SCALE_MASK;
+    if (scale)
+        exponent++;
+
+    int32_t dc = (int32_t)data[0] + data[1];
+    int32_t nyquist = (int32_t)data[0] - data[1];
+    data[0] = scale ? dc >> 1 : dc;
+    data[1] = scale ? nyquist >> 1 : nyquist;
+
+    for (uint16_t k = 1; k <= half / 2; k++) {
+        int16_t *p = &data[2 * k];
+        int16_t *q = &data[2 * (half - k)];
+        int16_t e_re = ((int32_t)p[0] + q[0]) >> 1;
+        int16_t e_im = ((int32_t)p[1] - q[1]) >> 1;
+        int16_t o_re = ((int32_t)p[1] + q[1]) >> 1;
+        int16_t o_im = ((int32_t)q[0] - p[0]) >> 1;
+
+        int16_t c = pgm_read_word(&twiddle[k * stride][0]);
+        int16_t s = pgm_read_word(&twiddle[k * stride][1]);
+        int32_t tr = fix_macs16x16_32(fix_macs16x16_32(ROUND, o_re, c), o_im, s) >> 15;
+        int32_t ti = fix_macs16x16_32(fix_macs16x16_32(ROUND, o_im, c), o_re, -s) >> 15;
+
+        int32_t xr = e_re + tr, xi = e_im + ti;
+        int32_t yr = e_re - tr, yi = ti - e_im;
+        if (scale) {
+            xr >>= 1;
+            xi >>= 1;
+            yr >>= 1;
+            yi >>= 1;
+        }
+        // k = N/4 is its own partner: both give the same bin
+        p[0] = xr;
+        p[1] = xi;
+        q[0] = yr;
+        q[1] = yi;
+    }
+    return exponent;
+}
+
+void dsp_fft_magnitude(const int16_t *data, uint16_t *mag, uint16_t bins) {
+    while (bins--) {
+        uint16_t x = abs16(*data++);
+        uint16_t y = abs16(*data++);
+        uint16_t big = (x > y) ? x : y;
+        uint16_t small = (x > y) ? y : x;
+        uint16_t alt = big - (big >> 3) + (small >> 1);
+        *mag++ = (alt > big) ? alt : big;
+    }
+}
@@ -0,0 +1,116 @@
+#include "dsp.h"
+#include "pgmspace.h"
+
+#define FIR_SHIFT 15
+
+static inline int16_t saturate16(int32_t v) {
+    if (v > INT16_MAX)
+        return INT16_MAX;
+    if (v < INT16_MIN)
+        return INT16_MIN;
+    return (int16_t)v;
+}
+
+// --- FIR ---
+
+void dsp_fir_init(dsp_fir_t *fir, const q15_t *taps, int16_t *delay, uint8_t ntaps) {
+    fir->taps = taps;
+    fir->delay = delay;
+    fir->ntaps = ntaps;
+    dsp_fir_reset(fir);
+}
+
+void dsp_fir_reset(dsp_fir_t *fir) {
+    for (uint8_t i = 0; i < fir->ntaps; i++)
+        fir->delay[i] = 0;
+    fir->pos = 0;
+}
+
+static int32_t dot(int32_t acc, const int16_t *x, const q15_t *taps, uint8_t n) {
+    while (n--)
+        acc = fix_macs16x16_32(acc, *x++, (int16_t)pgm_read_word(taps++));
+    return acc;
+}
+
+// The history is a ring written downwards, so from the newest sample the
+// older ones follow at rising addresses: two straight runs, no index wrap
+// inside the tap loop
+int16_t dsp_fir(dsp_fir_t *fir, int16_t x) {
+    uint8_t pos = fir->pos ? fir->pos - 1 : fir->ntaps - 1;
+    uint8_t first = fir->ntaps - pos;
+    fir->delay[pos] = x;
+    fir->pos = pos;
+
+    int32_t acc = (int32_t)1 << (FIR_SHIFT - 1);    // rounding
+    acc = dot(acc, &fir->delay[pos], fir->taps, first);
+    acc = dot(acc, fir->delay, fir->taps + first, pos);
+    return saturate16(acc >> FIR_SHIFT);
+}
+
+void dsp_fir_block(dsp_fir_t *fir, const int16_t *in, int16_t *out, uint16_t n) {
+    while (n--)
+        *out++ = dsp_fir(fir, *in++);
+}
+
+// --- Biquad IIR ---
+
+void dsp_biquad_init(dsp_biquad_t *iir, const dsp_biquad_coeffs_t *coeffs,
+                     dsp_biquad_state_t *state, uint8_t sections) {
+    iir->coeffs = coeffs;
+    iir->state = state;
+    iir->sections = sections;
+    dsp_biquad_reset(iir);
+}
+
+void dsp_biquad_reset(dsp_biquad_t *iir) {
+    for (uint8_t i = 0; i < iir->sections; i++)
+        iir->state[i] = (dsp_biquad_state_t){ 0 };
+}
+
+static void load_coeffs(dsp_biquad_coeffs_t *c, const dsp_biquad_coeffs_t *flash) {
+    c->b0 = pgm_read_word(&flash->b0);
+    c->b1 = pgm_read_word(&flash->b1);
+    c->b2 = pgm_read_word(&flash->b2);
+    c->a1 = pgm_read_word(&flash->a1);
+    c->a2 = pgm_read_word(&flash->a2);
+}
+
+static inline __attribute__((always_inline))
+int16_t section(const dsp_biquad_coeffs_t *c, dsp_biquad_state_t *s, int16_t x) {
+    int32_t acc = (int32_t)1 << (DSP_BIQUAD_SHIFT - 1);     // rounding
+    acc = fix_macs16x16_32(acc, c->b0, x);
+    acc = fix_macs16x16_32(acc, c->b1, s->x1);
+    acc = fix_macs16x16_32(acc, c->b2, s->x2);
+    acc = fix_macs16x16_32(acc, c->a1, s->y1);
+    acc = fix_macs16x16_32(acc, c->a2, s->y2);
+    int16_t y = saturate16(acc >> DSP_BIQUAD_SHIFT);
+
+    s->x2 = s->x1;
+    s->x1 = x;
+    s->y2 = s->y1;
+    s->y1 = y;
+    return y;
+}
+
+int16_t dsp_biquad(dsp_biquad_t *iir, int16_t x) {
+    for (uint8_t i = 0; i < iir->sections; i++) {
+        dsp_biquad_coeffs_t c;
+        load_coeffs(&c, &iir->coeffs[i]);
+        x = section(&c, &iir->state[i], x);
+    }
+    return x;
+}
+
+void dsp_biquad_block(dsp_biquad_t *iir, const int16_t *in, int16_t *out, uint16_t n) {
+    for (uint8_t i = 0; i < iir->sections; i++) {
+        dsp_biquad_coeffs_t c;
+        load_coeffs(&c, &iir->coeffs[i]);
+        dsp_biquad_state_t s = iir->state[i];
+
+        // the first section reads the input, the others the previous output
+        const int16_t *src = i ? out : in;
+        for (uint16_t k = 0; k < n; k++)
+            out[k] = section(&c, &s, src[k]);
+        iir->state[i] = s;
+    }
+}
@@ -164,6 +164,13 @@ struct EmbeddedCliConfig {
      */
     uint16_t cliBufferSize;
 
+    /**
+     * Optional function that fills history buffer with items saved earlier
+     * (see embeddedCliGetHistory) and returns their count. Called from
+     * embeddedCliNew. NULL to start with empty history
+     */
+    uint16_t (*historyLoad)(char *buf, uint16_t size);
+
     /**
      * Whether autocompletion should be enabled.
      * If false, autocompletion is disabled but you still can use 'tab' to
@@ -186,6 +193,7 @@ struct EmbeddedCliConfig {
  * <li>cliBufferSize = 0</li>
  * <li>maxBindingCount = 8</li>
  * <li>enableAutoComplete = true</li>
+ * <li>historyLoad = NULL</li>
  * </ul>
  * @return configuration for cli creation
  */
@@ -258,6 +266,25 @@ void embeddedCliPrint(EmbeddedCli *cli, const char *string);
  */
 void embeddedCliFree(EmbeddedCli *cli);
 
+/**
+ * Return true if command history was modified since last call to
+ * embeddedCliGetHistory, so it is worth saving again
+ * @param cli
+ * @return true if history changed
+ */
+bool embeddedCliHistoryChanged(EmbeddedCli *cli);
+
+/**
+ * Get command history so it can be saved and given back to a later
+ * embeddedCliNew via historyLoad. Items are separated by null-chars, the
+ * most recent first; unused part of the buffer is zeroed. Buffer size is
+ * historyBufferSize.
+ * @param cli
+ * @param count - receives number of items
+ * @return history buffer
+ */
+const char *embeddedCliGetHistory(EmbeddedCli *cli, uint16_t *count);
+
 /**
  * Perform tokenization of arguments string. Original string is modified and
  * should not be used directly (only inside other token functions).
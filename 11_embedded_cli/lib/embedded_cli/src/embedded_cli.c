@@ -59,6 +59,12 @@
  */
 #define CLI_FLAG_AUTOCOMPLETE_ENABLED 0x20u
 
+/**
+ * Indicates that history was modified since it was last taken with
+ * embeddedCliGetHistory
+ */
+#define CLI_FLAG_HISTORY_CHANGED 0x40u
+
 /**
 * Indicates that cursor direction should be forward
 */
@@ -417,6 +423,15 @@ static const char *historyGet(CliHistory *history, uint16_t item);
  */
 static void historyRemove(CliHistory *history, const char *str);
 
+/**
+ * Count items loaded into history buffer. Counting stops at the first item
+ * that is empty or not terminated inside the buffer
+ * @param history
+ * @param count - number of items that should be in buffer
+ * @return number of valid items
+ */
+static uint16_t historyCountValid(CliHistory *history, uint16_t count);
+
 /**
  * Return position (index of first char) of specified token
  * @param tokenizedStr - tokenized string (separated by \0 with
@@ -435,6 +450,7 @@ EmbeddedCliConfig *embeddedCliDefaultConfig(void) {
     defaultConfig.maxBindingCount = 8;
     defaultConfig.enableAutoComplete = true;
     defaultConfig.invitation = "> ";
+    defaultConfig.historyLoad = NULL;
     return &defaultConfig;
 }
 
@@ -509,6 +525,11 @@ EmbeddedCli *embeddedCliNew(EmbeddedCliConfig *config) {
     impl->invitation = config->invitation;
     impl->cursorPos = 0;
 
+    if (config->historyLoad != NULL) {
+        uint16_t count = config->historyLoad(impl->history.buf, impl->history.bufferSize);
+        impl->history.itemsCount = historyCountValid(&impl->history, count);
+    }
+
     initInternalBindings(cli);
 
     return cli;
@@ -615,6 +636,28 @@ void embeddedCliFree(EmbeddedCli *cli) {
     }
 }
 
+bool embeddedCliHistoryChanged(EmbeddedCli *cli) {
+    PREPARE_IMPL(cli);
+    return IS_FLAG_SET(impl->flags, CLI_FLAG_HISTORY_CHANGED);
+}
+
+const char *embeddedCliGetHistory(EmbeddedCli *cli, uint16_t *count) {
+    PREPARE_IMPL(cli);
+    CliHistory *history = &impl->history;
+
+    // zero the unused tail so it never differs between saved copies
+    uint16_t used = 0;
+    if (history->itemsCount > 0) {
+        const char *item = historyGet(history, history->itemsCount);
+        used = (uint16_t) (item - history->buf + strlen(item) + 1);
+    }
+    memset(&history->buf[used], 0, history->bufferSize - used);
+
+    UNSET_U8FLAG(impl->flags, CLI_FLAG_HISTORY_CHANGED);
+    *count = history->itemsCount;
+    return history->buf;
+}
+
 void embeddedCliTokenizeArgs(char *args) {
     if (args == NULL)
         return;
@@ -836,7 +879,10 @@ static void parseCommand(EmbeddedCli *cli) {
     if (isEmpty)
         return;
     // push command to history before buffer is modified
-    historyPut(&impl->history, impl->cmdBuffer);
+    const char *lastItem = historyGet(&impl->history, 1);
+    bool repeated = lastItem != NULL && strcmp(lastItem, impl->cmdBuffer) == 0;
+    if (historyPut(&impl->history, impl->cmdBuffer) && !repeated)
+        SET_FLAG(impl->flags, CLI_FLAG_HISTORY_CHANGED);
 
     char *cmdName = NULL;
     char *cmdArgs = NULL;
@@ -1273,6 +1319,19 @@ static void historyRemove(CliHistory *history, const char *str) {
     memmove(item, &item[len + 1], remaining);
 }
 
+static uint16_t historyCountValid(CliHistory *history, uint16_t count) {
+    uint16_t pos = 0;
+    for (uint16_t i = 0; i < count; ++i) {
+        uint16_t start = pos;
+        while (pos < history->bufferSize && history->buf[pos] != '\0')
+            ++pos;
+        if (pos == history->bufferSize || pos == start)
+            return i;
+        ++pos;
+    }
+    return count;
+}
+
 static uint16_t getTokenPosition(const char *tokenizedStr, uint16_t pos) {
     if (tokenizedStr == NULL || pos == 0)
         return CLI_TOKEN_NPOS;
@@ -0,0 +1,292 @@
+#ifndef FIXMATH_H
+#define FIXMATH_H
+
+#include "stdint.h"
+#include "stdbool.h"
+
+// -----------------------------------------------------------------------------
+// Fixed-point formats
+// -----------------------------------------------------------------------------
+// q8_t  - Q8.8   signed, 8 integer bits, 8 fraction bits   (-128 .. 127.996)
+// q16_t - Q16.16 signed, 16 integer bits, 16 fraction bits (-32768 .. 32767.99998)
+// q15_t - Q1.15  signed fraction                            (-1 .. 0.99997)
+//
+// Angles are binary angles: 0x0000 = 0, 0x4000 = 90 deg, 0x8000 = 180 deg,
+// so wrap-around is free and no range reduction is needed.
+//
+// The multiply kernels below use the ATmega hardware multiplier
+// (MUL/MULS/MULSU/FMUL/FMULS/FMULSU) through inline assembly, following
+// Atmel application note AVR201. Non-AVR builds (host tools) fall back to C.
+typedef int16_t q8_t;
+typedef int32_t q16_t;
+typedef int16_t q15_t;
+
+#define Q8_ONE   ((q8_t)0x0100)
+#define Q16_ONE  ((q16_t)0x00010000L)
+#define Q15_ONE  ((q15_t)0x7FFF)       // closest value to 1.0
+
+#define Q8_MAX   ((q8_t)INT16_MAX)
+#define Q8_MIN   ((q8_t)INT16_MIN)
+#define Q16_MAX  ((q16_t)INT32_MAX)
+#define Q16_MIN  ((q16_t)INT32_MIN)
+
+// Compile-time conversions (use with constants only, no float at runtime)
+#define Q8_FROM_FLOAT(x)  ((q8_t)((x) * 256.0 + ((x) >= 0 ? 0.5 : -0.5)))
+#define Q16_FROM_FLOAT(x) ((q16_t)((x) * 65536.0 + ((x) >= 0 ? 0.5 : -0.5)))
+#define Q15_FROM_FLOAT(x) ((q15_t)((x) * 32768.0 + ((x) >= 0 ? 0.5 : -0.5)))
+#define Q8_FROM_INT(x)    ((q8_t)((int16_t)(x) * 256))
+#define Q16_FROM_INT(x)   ((q16_t)((int32_t)(x) * 65536L))
+#define Q8_TO_INT(x)      ((int16_t)((x) >> 8))
+#define Q16_TO_INT(x)     ((int32_t)((x) >> 16))
+
+#define FIX_ANGLE_FROM_DEG(d) ((uint16_t)((int32_t)((d) * 65536.0 / 360.0)))
+
+// -----------------------------------------------------------------------------
+// Multiply kernels (hot path, always inlined)
+// -----------------------------------------------------------------------------
+
+// Signed 16 x 16 -> 32 bit multiply
+static inline __attribute__((always_inline)) int32_t fix_muls16x16_32(int16_t a, int16_t b) {
+#if defined(__AVR__)
+    int32_t r;
+    uint8_t zero;
+    __asm__ (
+        "clr   %[z]"          "\n\t"
+        "muls  %B[a], %B[b]"  "\n\t"   // ah * bh
+        "movw  %C[r], r0"     "\n\t"
+        "mul   %A[a], %A[b]"  "\n\t"   // al * bl
+        "movw  %A[r], r0"     "\n\t"
+        "mulsu %B[a], %A[b]"  "\n\t"   // ah * bl
+        "sbc   %D[r], %[z]"   "\n\t"   // sign extend
+        "add   %B[r], r0"     "\n\t"
+        "adc   %C[r], r1"     "\n\t"
+        "adc   %D[r], %[z]"   "\n\t"
+        "mulsu %B[b], %A[a]"  "\n\t"   // bh * al
+        "sbc   %D[r], %[z]"   "\n\t"
+        "add   %B[r], r0"     "\n\t"
+        "adc   %C[r], r1"     "\n\t"
+        "adc   %D[r], %[z]"   "\n\t"
+        "clr   r1"                     // restore __zero_reg__
+        : [r] "=&r" (r), [z] "=&r" (zero)
+        : [a] "a" (a), [b] "a" (b)
+        : "r0"
+    );
+    return r;
+#else
+    return (int32_t)a * b;
+#endif
+}
+
+// Signed 16 x unsigned 16 -> 32 bit multiply
+static inline __attribute__((always_inline)) int32_t fix_mulsu16x16_32(int16_t a, uint16_t b) {
+#if defined(__AVR__)
+    int32_t r;
+    uint8_t zero;
+    __asm__ (
+        "clr   %[z]"          "\n\t"
+        "mulsu %B[a], %B[b]"  "\n\t"   // ah * bh
+        "movw  %C[r], r0"     "\n\t"
+        "mul   %A[a], %A[b]"  "\n\t"   // al * bl
+        "movw  %A[r], r0"     "\n\t"
+        "mulsu %B[a], %A[b]"  "\n\t"   // ah * bl
+        "sbc   %D[r], %[z]"   "\n\t"   // sign extend
+        "add   %B[r], r0"     "\n\t"
+        "adc   %C[r], r1"     "\n\t"
+        "adc   %D[r], %[z]"   "\n\t"
+        "mul   %A[a], %B[b]"  "\n\t"   // al * bh
+        "add   %B[r], r0"     "\n\t"
+        "adc   %C[r], r1"     "\n\t"
+        "adc   %D[r], %[z]"   "\n\t"
+        "clr   r1"
+        : [r] "=&r" (r), [z] "=&r" (zero)
+        : [a] "a" (a), [b] "a" (b)
+        : "r0"
+    );
+    return r;
+#else
+    return (int32_t)a * (int32_t)b;
+#endif
+}
+
+// Unsigned 16 x 16 -> 32 bit multiply
+static inline __attribute__((always_inline)) uint32_t fix_mulu16x16_32(uint16_t a, uint16_t b) {
+#if defined(__AVR__)
+    uint32_t r;
+    uint8_t zero;
+    __asm__ (
+        "clr   %[z]"          "\n\t"
+        "mul   %B[a], %B[b]"  "\n\t"   // ah * bh
+        "movw  %C[r], r0"     "\n\t"
+        "mul   %A[a], %A[b]"  "\n\t"   // al * bl
+        "movw  %A[r], r0"     "\n\t"
+        "mul   %B[a], %A[b]"  "\n\t"   // ah * bl
+        "add   %B[r], r0"     "\n\t"
+        "adc   %C[r], r1"     "\n\t"
+        "adc   %D[r], %[z]"   "\n\t"
+        "mul   %A[a], %B[b]"  "\n\t"   // al * bh
+        "add   %B[r], r0"     "\n\t"
+        "adc   %C[r], r1"     "\n\t"
+        "adc   %D[r], %[z]"   "\n\t"
+        "clr   r1"
+        : [r] "=&r" (r), [z] "=&r" (zero)
+        : [a] "r" (a), [b] "r" (b)
+        : "r0"
+    );
+    return r;
+#else
+    return (uint32_t)a * b;
+#endif
+}
+
+// Signed fractional 16 x 16 -> 32 bit multiply: (a * b) << 1
+// Both operands are Q1.15, the result is Q1.31. -1 * -1 wraps to -1.
+static inline __attribute__((always_inline)) int32_t fix_fmuls16x16_32(int16_t a, int16_t b) {
+#if defined(__AVR__)
+    int32_t r;
+    uint8_t zero;
+    __asm__ (
+        "clr    %[z]"          "\n\t"
+        "fmuls  %B[a], %B[b]"  "\n\t"   // ah * bh
+        "movw   %C[r], r0"     "\n\t"
+        "fmul   %A[a], %A[b]"  "\n\t"   // al * bl
+        "adc    %C[r], %[z]"   "\n\t"
+        "movw   %A[r], r0"     "\n\t"
+        "fmulsu %B[a], %A[b]"  "\n\t"   // ah * bl
+        "sbc    %D[r], %[z]"   "\n\t"
+        "add    %B[r], r0"     "\n\t"
+        "adc    %C[r], r1"     "\n\t"
+        "adc    %D[r], %[z]"   "\n\t"
+        "fmulsu %B[b], %A[a]"  "\n\t"   // bh * al
+        "sbc    %D[r], %[z]"   "\n\t"
+        "add    %B[r], r0"     "\n\t"
+        "adc    %C[r], r1"     "\n\t"
+        "adc    %D[r], %[z]"   "\n\t"
+        "clr    r1"
+        : [r] "=&r" (r), [z] "=&r" (zero)
+        : [a] "a" (a), [b] "a" (b)
+        : "r0"
+    );
+    return r;
+#else
+    return (int32_t)((uint32_t)((int32_t)a * b) << 1);
+#endif
+}
+
+// Signed multiply-accumulate: acc + a * b, all 32 bits kept (wraps).
+// The partial products are added straight into the accumulator, saving
+// the moves of fix_muls16x16_32() in filter loops.
+static inline __attribute__((always_inline)) int32_t fix_macs16x16_32(int32_t acc, int16_t a, int16_t b) {
+#if defined(__AVR__)
+    uint8_t zero;
+    __asm__ (
+        "clr   %[z]"          "\n\t"
+        "muls  %B[a], %B[b]"  "\n\t"   // ah * bh
+        "add   %C[r], r0"     "\n\t"
+        "adc   %D[r], r1"     "\n\t"
+        "mul   %A[a], %A[b]"  "\n\t"   // al * bl
+        "add   %A[r], r0"     "\n\t"
+        "adc   %B[r], r1"     "\n\t"
+        "adc   %C[r], %[z]"   "\n\t"
+        "adc   %D[r], %[z]"   "\n\t"
+        "mulsu %B[a], %A[b]"  "\n\t"   // ah * bl
+        "sbc   %D[r], %[z]"   "\n\t"   // sign extend
+        "add   %B[r], r0"     "\n\t"
+        "adc   %C[r], r1"     "\n\t"
+        "adc   %D[r], %[z]"   "\n\t"
+        "mulsu %B[b], %A[a]"  "\n\t"   // bh * al
+        "sbc   %D[r], %[z]"   "\n\t"
+        "add   %B[r], r0"     "\n\t"
+        "adc   %C[r], r1"     "\n\t"
+        "adc   %D[r], %[z]"   "\n\t"
+        "clr   r1"
+        : [r] "+r" (acc), [z] "=&r" (zero)
+        : [a] "a" (a), [b] "a" (b)
+        : "r0"
+    );
+    return acc;
+#else
+    return (int32_t)((uint32_t)acc + (uint32_t)((int32_t)a * b));
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Saturating arithmetic
+// -----------------------------------------------------------------------------
+static inline q8_t q8_add_sat(q8_t a, q8_t b) {
+    int16_t r;
+    if (__builtin_add_overflow(a, b, &r))
+        return a < 0 ? Q8_MIN : Q8_MAX;
+    return r;
+}
+
+static inline q8_t q8_sub_sat(q8_t a, q8_t b) {
+    int16_t r;
+    if (__builtin_sub_overflow(a, b, &r))
+        return a < 0 ? Q8_MIN : Q8_MAX;
+    return r;
+}
+
+static inline q16_t q16_add_sat(q16_t a, q16_t b) {
+    int32_t r;
+    if (__builtin_add_overflow(a, b, &r))
+        return a < 0 ? Q16_MIN : Q16_MAX;
+    return r;
+}
+
+static inline q16_t q16_sub_sat(q16_t a, q16_t b) {
+    int32_t r;
+    if (__builtin_sub_overflow(a, b, &r))
+        return a < 0 ? Q16_MIN : Q16_MAX;
+    return r;
+}
+
+// Clamp a 32-bit intermediate into Q8.8 range
+static inline q8_t q8_sat32(int32_t x) {
+    if (x > Q8_MAX) return Q8_MAX;
+    if (x < Q8_MIN) return Q8_MIN;
+    return (q8_t)x;
+}
+
+// -----------------------------------------------------------------------------
+// Multiply / divide (rounded to nearest, saturating)
+// -----------------------------------------------------------------------------
+
+// Q8.8 multiply: (a * b) >> 8
+static inline q8_t q8_mul(q8_t a, q8_t b) {
+    return q8_sat32((fix_muls16x16_32(a, b) + 0x80) >> 8);
+}
+
+// Q1.15 multiply: (a * b) >> 15, -1 * -1 saturates to Q15_ONE
+static inline q15_t q15_mul(q15_t a, q15_t b) {
+    if (a == INT16_MIN && b == INT16_MIN)
+        return Q15_ONE;
+    return (q15_t)((fix_fmuls16x16_32(a, b) + 0x8000L) >> 16);
+}
+
+q16_t q16_mul(q16_t a, q16_t b);
+
+q8_t q8_div(q8_t a, q8_t b);
+q16_t q16_div(q16_t a, q16_t b);
+
+q8_t q8_recip(q8_t a);
+q16_t q16_recip(q16_t a);
+
+// Square root; negative input returns 0
+q8_t q8_sqrt(q8_t a);
+q16_t q16_sqrt(q16_t a);
+
+// -----------------------------------------------------------------------------
+// Trigonometry (quarter-wave table in flash + linear interpolation)
+// -----------------------------------------------------------------------------
+q15_t fix_sin(uint16_t angle);
+q15_t fix_cos(uint16_t angle);
+
+// -----------------------------------------------------------------------------
+// Exponential / logarithm (table + interpolation, ~1e-4 relative error)
+// -----------------------------------------------------------------------------
+q16_t q16_exp2(q16_t x);   // saturates to Q16_MAX above 2^15
+q16_t q16_log2(q16_t x);   // x <= 0 returns Q16_MIN
+q16_t q16_exp(q16_t x);
+q16_t q16_log(q16_t x);
+
+#endif // FIXMATH_H
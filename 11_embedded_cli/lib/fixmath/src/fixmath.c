@@ -0,0 +1,233 @@
+#include "fixmath.h"
+#include "pgmspace.h"
+
+// sin(i * 90deg / 64) in Q1.15, i = 0..64
+static const int16_t sin_table[65] PROGMEM = {
+        0,   804,  1608,  2411,  3212,  4011,  4808,  5602,
+     6393,  7180,  7962,  8740,  9512, 10279, 11039, 11793,
+    12540, 13279, 14010, 14733, 15447, 16151, 16846, 17531,
+    18205, 18868, 19520, 20160, 20788, 21403, 22006, 22595,
+    23170, 23732, 24279, 24812, 25330, 25833, 26320, 26791,
+    27246, 27684, 28106, 28511, 28899, 29269, 29622, 29957,
+    30274, 30572, 30853, 31114, 31357, 31581, 31786, 31972,
+    32138, 32286, 32413, 32522, 32610, 32679, 32729, 32758,
+    32767
+};
+
+// log2(1 + i / 32) in Q0.16, i = 0..31 (i = 32 would be 1.0)
+static const uint16_t log2_table[32] PROGMEM = {
+        0,  2909,  5732,  8473, 11136, 13727, 16248, 18704,
+    21098, 23433, 25711, 27936, 30109, 32234, 34312, 36346,
+    38336, 40286, 42196, 44068, 45904, 47705, 49472, 51207,
+    52911, 54584, 56229, 57845, 59434, 60997, 62534, 64047
+};
+
+// 2^(i / 32) - 1 in Q0.16, i = 0..31 (i = 32 would be 1.0)
+static const uint16_t exp2_table[32] PROGMEM = {
+        0,  1435,  2902,  4400,  5932,  7496,  9096, 10730,
+    12400, 14106, 15850, 17633, 19454, 21315, 23216, 25160,
+    27146, 29175, 31249, 33369, 35534, 37747, 40009, 42320,
+    44682, 47095, 49562, 52082, 54658, 57289, 59979, 62727
+};
+
+#define Q16_LOG2_E  94548L  // log2(e) in Q16.16
+#define Q16_LN_2    45426L  // ln(2) in Q16.16
+
+// --- Multiply ---
+
+// Q16.16 multiply built from four 16 x 16 hardware multiplies:
+// a * b = ah*bh << 32 + (ah*bl + al*bh) << 16 + al*bl, keep bits 16..47
+q16_t q16_mul(q16_t a, q16_t b) {
+    int16_t ah = (int16_t)(a >> 16);
+    int16_t bh = (int16_t)(b >> 16);
+    uint16_t al = (uint16_t)a;
+    uint16_t bl = (uint16_t)b;
+
+    int32_t hi = fix_muls16x16_32(ah, bh);
+    int32_t mid1 = fix_mulsu16x16_32(ah, bl);
+    int32_t mid2 = fix_mulsu16x16_32(bh, al);
+    uint32_t lo = fix_mulu16x16_32(al, bl);
+
+    // Sum bits 16..31 of the terms separately and carry into the high word,
+    // so the range check sees the full 48-bit result: hi alone can be out of
+    // range while negative mid terms bring the sum back in
+    uint32_t low = (uint16_t)mid1 + (uint16_t)mid2 + ((lo + 0x8000UL) >> 16);
+    int32_t high = hi + (mid1 >> 16) + (mid2 >> 16) + (int32_t)(low >> 16);
+    if (high > INT16_MAX || high < INT16_MIN)
+        return (high < 0) ? Q16_MIN : Q16_MAX;
+    return (q16_t)(((uint32_t)high << 16) | (uint16_t)low);
+}
+
+// --- Divide ---
+
+// (a << 16) / b for unsigned operands, false if the quotient overflows
+// 31 bits. Restoring division: integer part from the 32-bit divide, then
+// 16 fraction bits one at a time so no 64-bit arithmetic is needed.
+static bool udiv_q16(uint32_t a, uint32_t b, uint32_t *result) {
+    uint32_t q = a / b;
+    uint32_t r = a % b;
+
+    if (q > 0x7FFF)
+        return false;
+
+    for (uint8_t i = 0; i < 16; i++) {
+        r <<= 1;
+        q <<= 1;
+        if (r >= b) {
+            r -= b;
+            q |= 1;
+        }
+    }
+    // round to nearest
+    if ((r << 1) >= b && q < 0x7FFFFFFFUL)
+        q++;
+
+    *result = q;
+    return true;
+}
+
+q16_t q16_div(q16_t a, q16_t b) {
+    bool negative = (a ^ b) < 0;
+    if (b == 0)
+        return (a < 0) ? Q16_MIN : Q16_MAX;
+
+    uint32_t ua = (a < 0) ? -(uint32_t)a : (uint32_t)a;
+    uint32_t ub = (b < 0) ? -(uint32_t)b : (uint32_t)b;
+    uint32_t q;
+    if (!udiv_q16(ua, ub, &q))
+        return negative ? Q16_MIN : Q16_MAX;
+
+    return negative ? -(q16_t)q : (q16_t)q;
+}
+
+q8_t q8_div(q8_t a, q8_t b) {
+    if (b == 0)
+        return (a < 0) ? Q8_MIN : Q8_MAX;
+
+    int32_t n = (int32_t)a * 256L;
+    int32_t d = b;
+    int32_t half = ((d < 0) ? -d : d) / 2;
+    // round half away from zero
+    n += ((n < 0) != (d < 0)) ? -half : half;
+    return q8_sat32(n / d);
+}
+
+q16_t q16_recip(q16_t a) {
+    return q16_div(Q16_ONE, a);
+}
+
+q8_t q8_recip(q8_t a) {
+    return q8_div(Q8_ONE, a);
+}
+
+// --- Square root ---
+
+// Bit-by-bit integer square root. Consumes the input two bits at a time
+// from the top of 'x', feeding zeros once it runs out, so 'iterations'
+// result bits of sqrt(x * 4^(iterations - 16)) are produced.
+static uint32_t isqrt_bits(uint32_t x, uint8_t iterations) {
+    uint32_t rem = 0;
+    uint32_t root = 0;
+
+    while (iterations--) {
+        rem = (rem << 2) | (x >> 30);
+        x <<= 2;
+        root <<= 1;
+        uint32_t trial = (root << 1) | 1;
+        if (rem >= trial) {
+            rem -= trial;
+            root |= 1;
+        }
+    }
+    // round to nearest
+    if (rem > root)
+        root++;
+    return root;
+}
+
+q16_t q16_sqrt(q16_t a) {
+    if (a <= 0)
+        return 0;
+    // sqrt(a * 2^16): 32 input bits plus 16 zero bits -> 24 result bits
+    return (q16_t)isqrt_bits((uint32_t)a, 24);
+}
+
+q8_t q8_sqrt(q8_t a) {
+    if (a <= 0)
+        return 0;
+    // sqrt(a * 2^8): 16 input bits plus 8 zero bits -> 12 result bits
+    return (q8_t)isqrt_bits((uint32_t)a << 16, 12);
+}
+
+// --- Trigonometry ---
+
+q15_t fix_sin(uint16_t angle) {
+    uint16_t pos = angle & 0x3FFF;      // position within the quadrant
+    if (angle & 0x4000)
+        pos = 0x4000 - pos;             // 2nd and 4th quadrant run backwards
+
+    uint8_t index = pos >> 8;           // 0..64
+    uint8_t frac = pos & 0xFF;
+    int16_t s = pgm_read_word(&sin_table[index]);
+    if (frac) {
+        int16_t next = pgm_read_word(&sin_table[index + 1]);
+        s += (int16_t)(fix_mulsu16x16_32(next - s, frac) >> 8);
+    }
+
+    return (angle & 0x8000) ? -s : s;
+}
+
+q15_t fix_cos(uint16_t angle) {
+    return fix_sin(angle + 0x4000);
+}
+
+// --- Exponential / logarithm ---
+
+// Linear interpolation in a 32-entry Q0.16 table whose implicit 33rd
+// entry is 1.0. 'pos' is a 16-bit position across the table.
+static uint32_t table_interp(const uint16_t *table, uint16_t pos) {
+    uint8_t index = pos >> 11;
+    uint16_t frac = pos & 0x07FF;
+    uint32_t a = pgm_read_word(&table[index]);
+    uint32_t b = (index < 31) ? pgm_read_word(&table[index + 1]) : 65536UL;
+    return a + ((fix_mulu16x16_32((uint16_t)(b - a), frac) + 0x400) >> 11);
+}
+
+q16_t q16_exp2(q16_t x) {
+    int16_t k = (int16_t)(x >> 16);                     // integer part (floor)
+    uint32_t m = Q16_ONE + table_interp(exp2_table, (uint16_t)x);
+
+    if (k >= 15)
+        return Q16_MAX;
+    if (k <= -17)
+        return 0;
+    if (k >= 0)
+        return (q16_t)(m << k);
+    return (q16_t)((m + ((uint32_t)1 << (-k - 1))) >> -k);
+}
+
+q16_t q16_log2(q16_t x) {
+    if (x <= 0)
+        return Q16_MIN;
+
+    // normalise x to m * 2^e with m in [1, 2): find the top set bit
+    int8_t e = 14;
+    uint32_t m = (uint32_t)x;
+    while (m < 0x40000000UL) {
+        m <<= 1;
+        e--;
+    }
+    // m is now 01xx..x (bit 30 set); the 16 bits below it are the mantissa
+    uint16_t frac = (uint16_t)(m >> 14);
+    return (q16_t)e * 65536L + (q16_t)table_interp(log2_table, frac);
+}
+
+q16_t q16_exp(q16_t x) {
+    return q16_exp2(q16_mul(x, Q16_LOG2_E));
+}
+
+q16_t q16_log(q16_t x) {
+    if (x <= 0)
+        return Q16_MIN;
+    return q16_mul(q16_log2(x), Q16_LN_2);
+}
@@ -0,0 +1,18 @@
+#ifndef MATH_H
+#define MATH_H
+
+// Soft-float math functions provided by the toolchain's libm (link with -lm).
+// On AVR double is the same 32-bit type as float. These are slow (hundreds to
+// thousands of cycles each); prefer lib/fixmath on the target and keep these
+// for reference results, e.g. in the bench command.
+
+#define M_PI 3.14159265358979323846
+
+double sin(double x);
+double cos(double x);
+double sqrt(double x);
+double exp(double x);
+double log(double x);
+double fabs(double x);
+
+#endif // MATH_H
@@ -5,7 +5,10 @@
 
 // Program memory macros for AVR
 #define PROGMEM __attribute__((section(".progmem.data")))
-#define PSTR(s) ((const char*)(s))
+
+// String literal kept in flash only, e.g. printf_P(PSTR("x = %d\n"), x).
+// The pointer is a flash address: read it with pgm_read_byte, never *p.
+#define PSTR(s) (__extension__({ static const char __c[] PROGMEM = (s); &__c[0]; }))
 
 // Low-level program memory read macros
 #define __LPM(addr) \
@@ -4,17 +4,18 @@
 // Simple heap implementation for embedded systems
 // This is a very basic implementation - for production use, consider a proper heap manager
 
-#define HEAP_SIZE 1024
-static char heap[HEAP_SIZE];
-static size_t heap_used = 0;
+// Free SRAM between the last static variable and the reserved stack area,
+// defined in linker.ld
+extern char __heap_start[], __heap_end[];
+static char *heap_next = __heap_start;
 
 void* malloc(size_t size) {
     // Simple linear allocator - no free() support
-    if (heap_used + size > HEAP_SIZE) {
+    if (size > (size_t)(__heap_end - heap_next)) {
         return 0; // Out of memory
     }
-    void* ptr = &heap[heap_used];
-    heap_used += size;
+    void* ptr = heap_next;
+    heap_next += size;
     return ptr;
 }
 
@@ -0,0 +1,239 @@
+#include "adc_cmd.h"
+#include "adc.h"
+#include "dsp.h"
+#include "events.h"
+#include "tick.h"
+#include "watchdog.h"
+#include "crash.h"
+#include "stdio.h"
+#include "string.h"
+
+#define VREF_MV 5000UL
+
+// fft: one channel through the scan sequencer, a frame per tick
+#define FFT_RATE_HZ     1000
+#define FFT_PEAKS       4
+
+// Channel list of the running scan, for printing
+static uint8_t scan_channels[ADC_SCAN_MAX];
+static uint8_t scan_count;
+
+// Channel mask from digits 0..7, 0 if any other character
+static uint8_t parse_channels(const char *s) {
+    uint8_t mask = 0;
+    for (; *s; s++) {
+        if (*s < '0' || *s > '7')
+            return 0;
+        mask |= 1 << (*s - '0');
+    }
+    return mask;
+}
+
+// Number from digits, -1 if empty, not a number or above 'max'
+static int16_t parse_number(const char *s, uint16_t max) {
+    if (s == NULL || *s == '\0')
+        return -1;
+    int16_t n = 0;
+    for (; *s; s++) {
+        if (*s < '0' || *s > '9')
+            return -1;
+        n = n * 10 + (*s - '0');
+        if (n > max)
+            return -1;
+    }
+    return n;
+}
+
+static uint16_t to_mv(uint16_t value, uint8_t bits) {
+    return (uint16_t)((value * VREF_MV) >> bits);
+}
+
+static void print_frame(void) {
+    const adc_frame_t *f = adc_scan_take();
+    if (f == NULL) {
+        printf_P(PSTR("No new frame, %u overruns\n"), adc_scan_overruns());
+        return;
+    }
+    printf_P(PSTR("Frame %u at %lu ms:"), f->seq, f->time_ms);
+    for (uint8_t i = 0; i < scan_count; i++)
+        printf_P(PSTR(" A%u %u mV"), scan_channels[i], to_mv(f->value[i], 10));
+    adc_scan_release();
+    printf_P(PSTR("\n%u overruns, %u conversions/s\n"), adc_scan_overruns(), adc_rate());
+}
+
+static void print_results(void) {
+    if (!adc_running()) {
+        printf_P(PSTR("ADC stopped\n"));
+        return;
+    }
+    if (scan_count) {
+        print_frame();
+        return;
+    }
+
+    for (uint8_t ch = 0; ch < 8; ch++) {
+        adc_result_t r;
+        uint32_t t = tick_micros();
+        bool valid = adc_read(ch, &r);
+        t = tick_micros() - t;
+        if (!valid)
+            continue;
+        printf_P(PSTR("  A%u: %u (%u mV), avg %u (%u mV), ema %u (%u mV), %u bits, read %lu us\n"),
+               ch, r.value, to_mv(r.value, r.bits), r.average, to_mv(r.average, r.bits),
+               r.ema, to_mv(r.ema, r.bits), r.bits, t);
+    }
+    printf_P(PSTR("%u conversions/s\n"), adc_rate());
+}
+
+// Collect 2^bits samples of 'channel', one per scan frame
+static bool fft_sample(int16_t *data, uint8_t bits, uint8_t channel) {
+    uint16_t n = 1 << bits;
+    if (!adc_scan_start(&channel, 1, 1000 / FFT_RATE_HZ))
+        return false;
+    scan_count = 0;                 // replaced by this scan, stopped below
+
+    for (uint16_t i = 0; i < n;) {
+        if (!event_take(EVENT_ADC_FRAME)) {
+            watchdog_wait();
+            continue;
+        }
+        const adc_frame_t *f = adc_scan_take();
+        if (f)
+            data[i++] = f->value[0];
+        adc_scan_release();
+    }
+    // with frames missed the samples are not evenly spaced
+    uint16_t overruns = adc_scan_overruns();
+    adc_stop();
+    if (overruns)
+        printf_P(PSTR("%u frames missed\n"), overruns);
+    return true;
+}
+
+// Bin k of the largest peaks (local maxima), largest first, 0 if unused
+static void find_peaks(const uint16_t *mag, uint16_t bins, uint16_t *peaks) {
+    for (uint8_t p = 0; p < FFT_PEAKS; p++)
+        peaks[p] = 0;
+    for (uint16_t k = 1; k < bins; k++) {
+        if (mag[k] < mag[k - 1] || (k + 1 < bins && mag[k] < mag[k + 1]))
+            continue;
+        for (uint8_t p = 0; p < FFT_PEAKS; p++) {
+            if (peaks[p] == 0 || mag[k] > mag[peaks[p]]) {
+                for (uint8_t q = FFT_PEAKS - 1; q > p; q--)
+                    peaks[q] = peaks[q - 1];
+                peaks[p] = k;
+                break;
+            }
+        }
+    }
+}
+
+static void fft(const char *points, const char *channel) {
+    int16_t *data = dsp_fft_buffer;
+    uint8_t bits = 7;
+    int16_t ch = 0;
+
+    if (points != NULL) {
+        int16_t n = parse_number(points, DSP_FFT_MAX_POINTS);
+        bits = (n == 64) ? 6 : (n == 128) ? 7 : (n == 256) ? 8 : 0;
+    }
+    if (channel != NULL)
+        ch = parse_number(channel, 7);
+    if (bits == 0 || ch < 0 || !fft_sample(data, bits, ch)) {
+        printf_P(PSTR("Usage: fft [64|128|256] [channel 0..7]\n"));
+        return;
+    }
+
+    // remove the DC level, then 10-bit counts to Q1.15
+    uint16_t n = 1 << bits;
+    int32_t sum = 0;
+    for (uint16_t i = 0; i < n; i++)
+        sum += data[i];
+    int16_t mean = sum >> bits;
+    for (uint16_t i = 0; i < n; i++)
+        data[i] = (data[i] - mean) << 5;
+
+    uint32_t t = tick_micros();
+    int8_t e = dsp_fft_real(data, bits);
+    uint16_t *mag = (uint16_t *)data;
+    dsp_fft_magnitude(data, mag, n / 2);
+    t = tick_micros() - t;
+
+    uint16_t peaks[FFT_PEAKS];
+    mag[0] = 0;                     // DC and Nyquist, not a tone
+    find_peaks(mag, n / 2, peaks);
+
+    printf_P(PSTR("A%u: %u points at %u Hz, %u.%u Hz per bin, DC %u mV, FFT %lu us\n"),
+           ch, n, FFT_RATE_HZ, FFT_RATE_HZ / n, (uint16_t)(FFT_RATE_HZ * 10UL / n % 10),
+           to_mv(mean, 10), t);
+    for (uint8_t p = 0; p < FFT_PEAKS && peaks[p]; p++) {
+        uint16_t k = peaks[p];
+        uint16_t tenths = (uint32_t)k * FFT_RATE_HZ * 10 / n;
+        // a tone of amplitude A counts peaks at A * 32 * n / 2
+        uint32_t mv = ((uint32_t)mag[k] << e) / n * VREF_MV / 16384;
+        printf_P(PSTR("  %u.%u Hz: %lu mV\n"), tenths / 10, tenths % 10, mv);
+    }
+}
+
+void onAdc(EmbeddedCli *cli, char *args, void *context) {
+    (void)cli;
+    if (context == ADC_CMD_FFT) {
+        crash_trace(CRASH_TRACE_COMMAND, 'f');
+        fft(embeddedCliGetToken(args, 1), embeddedCliGetToken(args, 2));
+        return;
+    }
+    crash_trace(CRASH_TRACE_COMMAND, 'a');
+
+    const char *action = embeddedCliGetToken(args, 1);
+    if (action == NULL) {
+        print_results();
+        return;
+    }
+    if (strcmp(action, "stop") == 0) {
+        adc_stop();
+        scan_count = 0;
+        return;
+    }
+    if (strcmp(action, "scan") == 0) {
+        const char *channels = embeddedCliGetToken(args, 2);
+        const char *period = embeddedCliGetToken(args, 3);
+        int16_t ms = (period == NULL) ? 10 : parse_number(period, 255);
+        uint8_t list[ADC_SCAN_MAX];
+        uint8_t count = 0;
+        bool valid = channels != NULL && ms > 0;
+        for (; valid && channels[count]; count++) {
+            if (channels[count] < '0' || channels[count] > '7' || count == ADC_SCAN_MAX)
+                valid = false;
+            else
+                list[count] = channels[count] - '0';
+        }
+        if (valid && adc_scan_start(list, count, ms)) {
+            memcpy(scan_channels, list, count);
+            scan_count = count;
+            return;
+        }
+    }
+    if (strcmp(action, "start") == 0) {
+        const char *channels = embeddedCliGetToken(args, 2);
+        const char *bits = embeddedCliGetToken(args, 3);
+        uint8_t mask = channels ? parse_channels(channels) : 0;
+        uint8_t n = 0;
+        if (bits != NULL) {
+            if (bits[0] < '0' || bits[0] > '9' || bits[1] != '\0')
+                mask = 0;
+            n = bits[0] - '0';
+        }
+        if (mask && adc_start(mask, n)) {
+            scan_count = 0;
+            uint8_t count = 0;
+            for (uint8_t m = mask; m; m >>= 1)
+                count += m & 1;
+            printf_P(PSTR("%u bits, %u results/s per channel\n"),
+                   10 + n, (uint16_t)(ADC_CONVERSION_HZ / count >> (2 * n)));
+            return;
+        }
+    }
+    printf_P(PSTR("Usage: adc [start <channels 0..7> [bits 0..%u]|scan <channels> [period ms]|stop]\n"),
+           ADC_OVERSAMPLE_MAX);
+    printf_P(PSTR("Up to %u channels to start, %u to scan\n"), ADC_MAX_CHANNELS, ADC_SCAN_MAX);
+}
@@ -0,0 +1,21 @@
+#ifndef ADC_CMD_H
+#define ADC_CMD_H
+
+#include "embedded_cli.h"
+
+// `adc start <channels> [bits]` samples the given channels (digits, e.g.
+// 01 for A0 and A1) in the background with 4^bits oversampling, `adc`
+// shows their latest results in counts and mV along with the sample rate.
+// `adc scan <channels> [period]` converts the channel list (e.g. 012) as a
+// frame every period ms (default 10), `adc` then shows the newest frame.
+// `adc stop` turns the ADC off.
+//
+// Bound with ADC_CMD_FFT as context, the same handler serves
+// `fft [64|128|256] [channel]`: it samples one channel at 1 kHz through the
+// scan sequencer (replacing any running scan), runs a real FFT (dsp.h) and
+// prints the strongest tones with their amplitude.
+#define ADC_CMD_FFT ((void *)1)
+
+void onAdc(EmbeddedCli *cli, char *args, void *context);
+
+#endif // ADC_CMD_H
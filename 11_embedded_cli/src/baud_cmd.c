@@ -0,0 +1,70 @@
+#include "baud_cmd.h"
+#include "uart.h"
+#include "autobaud.h"
+#include "crash.h"
+#include "watchdog.h"
+#include "config.h"
+#include "stdio.h"
+#include "string.h"
+
+#define BAUD_AUTO_SECONDS  10
+#define BAUD_AUTO_SLICE_MS 250      // interrupts are off for this long at a time
+
+static void print_baud(void) {
+    uint8_t u2x = (UCSR0A & (1 << U2X0)) ? 1 : 0;
+    uint16_t ubrr = ((uint16_t)(UBRR0H & 0x0F) << 8) | UBRR0L;
+    printf_P(PSTR("Baud: %lu (UBRR %u, U2X %u)\n"), uart_baud(), ubrr, u2x);
+}
+
+// Decimal rate, 0 if not a number
+static uint32_t parse_rate(const char *s) {
+    uint32_t n = 0;
+    for (; *s; s++) {
+        if (*s < '0' || *s > '9' || n > 100000000UL)
+            return 0;
+        n = n * 10 + (*s - '0');
+    }
+    return n;
+}
+
+static void baud_auto(void) {
+    uart_divider_t d;
+
+    printf_P(PSTR("Send 'U' at the new rate within %u s...\n"), BAUD_AUTO_SECONDS);
+    uart_flush();
+    for (uint8_t i = 0; i < BAUD_AUTO_SECONDS * 1000 / BAUD_AUTO_SLICE_MS; i++) {
+        if (autobaud_measure(BAUD_AUTO_SLICE_MS, &d)) {
+            uart_set_divider(&d);
+            print_baud();
+            return;
+        }
+        watchdog_wait();
+    }
+    printf_P(PSTR("No 'U' received, rate unchanged\n"));
+}
+
+void onBaud(EmbeddedCli *cli, char *args, void *context) {
+    (void)cli;
+    (void)context;
+    crash_trace(CRASH_TRACE_COMMAND, 'B');
+
+    const char *action = embeddedCliGetToken(args, 1);
+    if (action == NULL) {
+        print_baud();
+        return;
+    }
+    if (strcmp(action, "auto") == 0) {
+        baud_auto();
+        return;
+    }
+
+    uint32_t rate = parse_rate(action);
+    uart_divider_t d;
+    if (rate == 0 || !uart_divider(8 * F_CPU / rate, &d) || d.error > BAUD_TOL * 100) {
+        printf_P(PSTR("Usage: baud [auto|<rate>], error within %u%%\n"), BAUD_TOL);
+        return;
+    }
+    printf_P(PSTR("Switching to %lu baud\n"), rate);
+    uart_set_divider(&d);
+    print_baud();
+}
@@ -0,0 +1,11 @@
+#ifndef BAUD_CMD_H
+#define BAUD_CMD_H
+
+#include "embedded_cli.h"
+
+// `baud` shows the UART rate, `baud <rate>` switches to it and `baud auto`
+// waits for a 'U' sent at the host's rate and switches to that (autobaud.h).
+// The host terminal must follow the new rate; a reset returns to BAUD.
+void onBaud(EmbeddedCli *cli, char *args, void *context);
+
+#endif // BAUD_CMD_H
@@ -0,0 +1,68 @@
+#include "bench.h"
+#include "crash.h"
+#include "watchdog.h"
+#include "stdio.h"
+#include "string.h"
+
+uint16_t bench_overhead;
+
+static const bench_suite_t suites[] = {
+    { "fixmath", bench_fixmath },
+    { "prng",    bench_prng },
+    { "isr",     bench_isr },
+    { "delay",   bench_delay },
+    { "boot",    bench_boot },
+    { "spi",     bench_spi },
+    { "filter",  bench_filter },
+    { "fft",     bench_fft },
+};
+
+#define BENCH_SUITE_COUNT (sizeof(suites) / sizeof(suites[0]))
+
+static void bench_calibrate(void) {
+    bench_overhead = 0;
+    cycles_start();
+    bench_overhead = cycles_stop();
+}
+
+void bench_acc_init(bench_acc_t *acc) {
+    acc->fixed_cycles = 0;
+    acc->float_cycles = 0;
+    acc->max_error = 0.0;
+}
+
+void bench_acc_error(bench_acc_t *acc, double got, double expected) {
+    double error = got - expected;
+    if (error < 0)
+        error = -error;
+    if (error > acc->max_error)
+        acc->max_error = error;
+}
+
+void bench_acc_report(const char *name, const bench_acc_t *acc, uint8_t samples) {
+    printf_P(PSTR("  %s: %lu cy, float %lu cy, max err %.2e\n"),
+           name, acc->fixed_cycles / samples, acc->float_cycles / samples, acc->max_error);
+    watchdog_wait();                // output paced by the UART, see main.c
+}
+
+void onBench(EmbeddedCli *cli, char *args, void *context) {
+    (void)cli;
+    (void)context;
+
+    const char *name = embeddedCliGetToken(args, 1);
+    bool found = false;
+    crash_trace(CRASH_TRACE_COMMAND, 'b');
+
+    bench_calibrate();
+    for (uint8_t i = 0; i < BENCH_SUITE_COUNT; i++) {
+        if (name == NULL || strcmp(name, suites[i].name) == 0) {
+            printf_P(PSTR("%s:\n"), suites[i].name);
+            suites[i].run();
+            watchdog_wait();
+            found = true;
+        }
+    }
+
+    if (!found)
+        printf_P(PSTR("Unknown suite: %s\n"), name);
+}
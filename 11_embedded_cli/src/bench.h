@@ -0,0 +1,58 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "stdint.h"
+#include "stdbool.h"
+#include "cycles.h"
+#include "embedded_cli.h"
+
+// Benchmark suites run from the CLI. Each suite times its operations with
+// the Timer1 cycle counter (see cycles.h) and prints one row per operation:
+// mean cycles of the integer/fixed-point version, mean cycles of the
+// soft-float reference and the largest absolute difference between them.
+
+typedef struct {
+    const char *name;
+    void (*run)(void);
+} bench_suite_t;
+
+// Accumulated results for one operation over a set of samples
+typedef struct {
+    uint32_t fixed_cycles;
+    uint32_t float_cycles;
+    double max_error;
+} bench_acc_t;
+
+// Cycles taken by an empty cycles_start()/cycles_stop() pair
+extern uint16_t bench_overhead;
+
+// Time a single statement, storing the cycle count in 'result', or
+// CYCLES_OVERFLOW unchanged if it ran too long to count
+#define BENCH_CYCLES(result, stmt)              \
+    do {                                        \
+        uint16_t bench_c_;                      \
+        cycles_start();                         \
+        stmt;                                   \
+        bench_c_ = cycles_stop();               \
+        (result) = (bench_c_ == CYCLES_OVERFLOW) \
+                 ? CYCLES_OVERFLOW : (uint16_t)(bench_c_ - bench_overhead); \
+    } while (0)
+
+void bench_acc_init(bench_acc_t *acc);
+void bench_acc_error(bench_acc_t *acc, double got, double expected);
+void bench_acc_report(const char *name, const bench_acc_t *acc, uint8_t samples);
+
+// CLI binding: "bench" runs every suite, "bench <suite>" runs one
+void onBench(EmbeddedCli *cli, char *args, void *context);
+
+// --- Suites ---
+void bench_fixmath(void);
+void bench_prng(void);
+void bench_isr(void);
+void bench_delay(void);
+void bench_boot(void);
+void bench_spi(void);
+void bench_filter(void);
+void bench_fft(void);
+
+#endif // BENCH_H
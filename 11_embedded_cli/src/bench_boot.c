@@ -0,0 +1,17 @@
+#include "bench.h"
+#include "boot.h"
+#include "config.h"
+#include "stdio.h"
+
+// Boot latency recorded by crt0 and boot_ready() (see boot.h). Nothing is
+// re-run here; the numbers are from the current power-up or reset.
+
+void bench_boot(void) {
+    if (boot_main_cycles == CYCLES_OVERFLOW)
+        printf_P(PSTR("  reset to main: > 65535 cy\n"));
+    else
+        printf_P(PSTR("  reset to main: %u cy (%lu us)\n"),
+               boot_main_cycles, (uint32_t)boot_main_cycles / (F_CPU / 1000000UL));
+    printf_P(PSTR("  reset to CLI ready: %lu cy (%lu us)\n"),
+           boot_ready_cycles, boot_ready_cycles / (F_CPU / 1000000UL));
+}
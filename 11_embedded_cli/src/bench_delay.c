@@ -0,0 +1,56 @@
+#include "bench.h"
+#include "avr/delay.h"
+#include "avr/interrupt.h"
+#include "stdio.h"
+
+// delay_cycles()/delay_us() against the Timer1 cycle counter. Every delay
+// must measure exactly the requested number of cycles; the sizes cover the
+// nop/rjmp padding, the 8-bit loop including its 256-iteration edge, the
+// 16-bit loop and the us conversion. Interrupts are disabled so the 1 ms
+// tick does not stretch a measurement.
+
+static uint8_t failures;
+
+static void check(const char *name, uint32_t expected, uint16_t measured) {
+    bool ok = measured == expected;
+    if (!ok)
+        failures++;
+    printf_P(PSTR("  %s: %lu cy, measured %u %s\n"), name, expected, measured, ok ? "ok" : "FAIL");
+}
+
+#define CHECK_CYCLES(n)                                         \
+    do {                                                        \
+        uint16_t c;                                             \
+        BENCH_CYCLES(c, delay_cycles(n));                       \
+        check(#n, n, c);                                        \
+    } while (0)
+
+#define CHECK_US(us)                                            \
+    do {                                                        \
+        uint16_t c;                                             \
+        BENCH_CYCLES(c, delay_us(us));                          \
+        check(#us " us", (uint32_t)(us) * (F_CPU / 1000000UL), c); \
+    } while (0)
+
+void bench_delay(void) {
+    uint8_t sreg = SREG;
+    cli();
+
+    failures = 0;
+    CHECK_CYCLES(1);
+    CHECK_CYCLES(2);
+    CHECK_CYCLES(5);
+    CHECK_CYCLES(6);
+    CHECK_CYCLES(100);
+    CHECK_CYCLES(768);
+    CHECK_CYCLES(770);
+    CHECK_CYCLES(771);
+    CHECK_CYCLES(10000);
+    CHECK_CYCLES(60000);
+    CHECK_US(1);
+    CHECK_US(10);
+    CHECK_US(1000);
+
+    SREG = sreg;
+    printf_P(PSTR("  %u failures\n"), failures);
+}
@@ -0,0 +1,52 @@
+#include "bench.h"
+#include "dsp.h"
+#include "tick.h"
+#include "stdio.h"
+
+// Fixed-point FFT at each size, real input (as the fft command uses it)
+// and complex, then the magnitude pass. A transform takes longer than the
+// 16-bit cycle counter reaches, so it is timed with tick_micros() (4 us
+// steps) with interrupts on; the 1 ms tick is included.
+//
+// Accuracy is checked on the host against a double-precision DFT:
+// tools/fft_accuracy.py.
+
+static void fill(int16_t *data, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++)
+        data[i] = (fix_sin(i * 0x0D00u) >> 1) + (fix_sin(i * 0x2900u) >> 2);
+}
+
+static void report(const char *name, uint16_t points, uint32_t us, int8_t exponent) {
+    printf_P(PSTR("  %s %u: %lu us, %lu cy, exponent %d, %lu/s max\n"),
+           name, points, us, us * (F_CPU / 1000000UL), exponent, us ? 1000000UL / us : 0);
+}
+
+void bench_fft(void) {
+    int16_t *data = dsp_fft_buffer;
+    uint32_t t;
+    int8_t e;
+
+    for (uint8_t bits = 6; bits <= DSP_FFT_MAX_BITS; bits++) {
+        uint16_t n = 1 << bits;
+        fill(data, n);
+        t = tick_micros();
+        e = dsp_fft_real(data, bits);
+        t = tick_micros() - t;
+        report("real", n, t, e);
+    }
+
+    // complex points take two values each
+    for (uint8_t bits = 6; bits < DSP_FFT_MAX_BITS; bits++) {
+        uint16_t n = 1 << bits;
+        fill(data, 2 * n);
+        t = tick_micros();
+        e = dsp_fft(data, bits);
+        t = tick_micros() - t;
+        report("complex", n, t, e);
+    }
+
+    t = tick_micros();
+    dsp_fft_magnitude(data, (uint16_t *)data, DSP_FFT_MAX_POINTS / 2);
+    t = tick_micros() - t;
+    printf_P(PSTR("  magnitude of %u bins: %lu us\n"), DSP_FFT_MAX_POINTS / 2, t);
+}
@@ -0,0 +1,130 @@
+#include "bench.h"
+#include "dsp.h"
+#include "filter_coeffs.h"
+#include "pgmspace.h"
+#include "stdio.h"
+
+// The filters of src/filters.json on a two-tone test signal. First one
+// sample at a time against a soft-float filter with the same (quantised)
+// coefficients, then the block API over BLOCK samples, reported per sample
+// and per tap or section, with the sample rate the filter alone would
+// keep up with: the budget for choosing a filter order.
+
+#define SAMPLES   16
+#define BLOCK     16
+#define MAX_TAPS  32
+#define MAX_SECTIONS 2
+
+static int16_t input[BLOCK];
+static int16_t output[BLOCK];
+static volatile int16_t out;
+static volatile double fr;
+
+static void make_input(void) {
+    for (uint8_t i = 0; i < BLOCK; i++)
+        input[i] = (fix_sin(i * 0x0B00u) >> 1) + (fix_sin(i * 0x3800u) >> 2);
+}
+
+static void report_block(uint16_t cycles, uint8_t units, const char *unit) {
+    uint16_t per_sample = cycles / BLOCK;
+    uint16_t tenths = (uint16_t)((uint32_t)cycles * 10 / BLOCK / units);
+    printf_P(PSTR("    block: %u cy/sample, %u.%u cy/sample/%s, %lu samples/s max\n"),
+           per_sample, tenths / 10, tenths % 10, unit, (uint32_t)F_CPU / per_sample);
+}
+
+static double float_fir(const double *h, const double *x, uint8_t n) {
+    double sum = 0;
+    for (uint8_t k = 0; k < n; k++)
+        sum += h[k] * x[k];
+    return sum;
+}
+
+static void bench_fir(const char *name, const q15_t *taps, uint8_t ntaps) {
+    int16_t delay[MAX_TAPS];
+    double h[MAX_TAPS], history[MAX_TAPS];
+    dsp_fir_t fir;
+    bench_acc_t acc;
+    uint16_t c;
+
+    for (uint8_t k = 0; k < ntaps; k++) {
+        h[k] = (int16_t)pgm_read_word(&taps[k]) / 32768.0;
+        history[k] = 0;
+    }
+    dsp_fir_init(&fir, taps, delay, ntaps);
+
+    bench_acc_init(&acc);
+    for (uint8_t i = 0; i < SAMPLES; i++) {
+        int16_t x = input[i % BLOCK];
+        BENCH_CYCLES(c, out = dsp_fir(&fir, x));
+        acc.fixed_cycles += c;
+        for (uint8_t k = ntaps - 1; k > 0; k--)
+            history[k] = history[k - 1];
+        history[0] = x / 32768.0;
+        BENCH_CYCLES(c, fr = float_fir(h, history, ntaps));
+        acc.float_cycles += c;
+        bench_acc_error(&acc, out / 32768.0, fr);
+    }
+    bench_acc_report(name, &acc, SAMPLES);
+
+    dsp_fir_reset(&fir);
+    BENCH_CYCLES(c, dsp_fir_block(&fir, input, output, BLOCK));
+    report_block(c, ntaps, "tap");
+}
+
+// Direct form I in soft float, coefficients as dsp.h stores them
+static double float_biquad(const dsp_biquad_coeffs_t *c, double s[][4], uint8_t sections, double x) {
+    for (uint8_t i = 0; i < sections; i++) {
+        double *z = s[i];
+        double y = (c[i].b0 * x + c[i].b1 * z[0] + c[i].b2 * z[1]
+                  + c[i].a1 * z[2] + c[i].a2 * z[3]) / 16384.0;
+        z[1] = z[0];
+        z[0] = x;
+        z[3] = z[2];
+        z[2] = y;
+        x = y;
+    }
+    return x;
+}
+
+static void bench_biquad(const char *name, const dsp_biquad_coeffs_t *coeffs, uint8_t sections) {
+    dsp_biquad_coeffs_t c[MAX_SECTIONS];
+    dsp_biquad_state_t state[MAX_SECTIONS];
+    double s[MAX_SECTIONS][4] = { { 0 } };
+    dsp_biquad_t iir;
+    bench_acc_t acc;
+    uint16_t cy;
+
+    for (uint8_t i = 0; i < sections; i++) {
+        c[i].b0 = pgm_read_word(&coeffs[i].b0);
+        c[i].b1 = pgm_read_word(&coeffs[i].b1);
+        c[i].b2 = pgm_read_word(&coeffs[i].b2);
+        c[i].a1 = pgm_read_word(&coeffs[i].a1);
+        c[i].a2 = pgm_read_word(&coeffs[i].a2);
+    }
+    dsp_biquad_init(&iir, coeffs, state, sections);
+
+    bench_acc_init(&acc);
+    for (uint8_t i = 0; i < SAMPLES; i++) {
+        int16_t x = input[i % BLOCK];
+        BENCH_CYCLES(cy, out = dsp_biquad(&iir, x));
+        acc.fixed_cycles += cy;
+        BENCH_CYCLES(cy, fr = float_biquad(c, s, sections, x / 32768.0));
+        acc.float_cycles += cy;
+        bench_acc_error(&acc, out / 32768.0, fr);
+    }
+    bench_acc_report(name, &acc, SAMPLES);
+
+    dsp_biquad_reset(&iir);
+    BENCH_CYCLES(cy, dsp_biquad_block(&iir, input, output, BLOCK));
+    report_block(cy, sections, "section");
+}
+
+void bench_filter(void) {
+    make_input();
+    bench_fir("fir 8 taps", lp_fir_8, LP_FIR_8_TAPS);
+    bench_fir("fir 16 taps", lp_fir_16, LP_FIR_16_TAPS);
+    bench_fir("fir 32 taps", lp_fir_32, LP_FIR_32_TAPS);
+    bench_biquad("biquad lowpass 2", lp_iir_2, LP_IIR_2_SECTIONS);
+    bench_biquad("biquad lowpass 4", lp_iir_4, LP_IIR_4_SECTIONS);
+    bench_biquad("biquad notch", notch_iir, NOTCH_IIR_SECTIONS);
+}
@@ -0,0 +1,160 @@
+#include "bench.h"
+#include "fixmath.h"
+#include "math.h"
+
+// Fixed-point library against libm soft-float. Inputs and outputs go
+// through volatile variables so the compiler cannot fold or hoist the
+// measured operation out of the timed region.
+
+#define SAMPLES 32
+
+static volatile q16_t qa, qb, qr;
+static volatile q15_t sa, sb, sr;
+static volatile uint16_t angle;
+static volatile double fa, fb, fr;
+
+static void bench_q16_mul(void) {
+    bench_acc_t acc;
+    uint16_t c;
+
+    bench_acc_init(&acc);
+    for (uint8_t i = 0; i < SAMPLES; i++) {
+        double a = ((int8_t)i - 16) * 1.37 + 0.25;
+        double b = i * 0.61 - 7.3;
+        qa = Q16_FROM_FLOAT(a);
+        qb = Q16_FROM_FLOAT(b);
+        fa = a;
+        fb = b;
+        BENCH_CYCLES(c, qr = q16_mul(qa, qb));
+        acc.fixed_cycles += c;
+        BENCH_CYCLES(c, fr = fa * fb);
+        acc.float_cycles += c;
+        bench_acc_error(&acc, qr / 65536.0, fr);
+    }
+    bench_acc_report("q16_mul", &acc, SAMPLES);
+}
+
+static void bench_q15_mul(void) {
+    bench_acc_t acc;
+    uint16_t c;
+
+    bench_acc_init(&acc);
+    for (uint8_t i = 0; i < SAMPLES; i++) {
+        double a = ((int8_t)i - 16) / 17.0;
+        double b = (31 - 2 * (int8_t)i) / 33.0;
+        sa = Q15_FROM_FLOAT(a);
+        sb = Q15_FROM_FLOAT(b);
+        fa = a;
+        fb = b;
+        BENCH_CYCLES(c, sr = q15_mul(sa, sb));
+        acc.fixed_cycles += c;
+        BENCH_CYCLES(c, fr = fa * fb);
+        acc.float_cycles += c;
+        bench_acc_error(&acc, sr / 32768.0, fr);
+    }
+    bench_acc_report("q15_mul", &acc, SAMPLES);
+}
+
+static void bench_q16_div(void) {
+    bench_acc_t acc;
+    uint16_t c;
+
+    bench_acc_init(&acc);
+    for (uint8_t i = 0; i < SAMPLES; i++) {
+        double a = ((int8_t)i - 16) * 5.3 + 1.1;
+        double b = i * 0.37 + 0.5;
+        qa = Q16_FROM_FLOAT(a);
+        qb = Q16_FROM_FLOAT(b);
+        fa = a;
+        fb = b;
+        BENCH_CYCLES(c, qr = q16_div(qa, qb));
+        acc.fixed_cycles += c;
+        BENCH_CYCLES(c, fr = fa / fb);
+        acc.float_cycles += c;
+        bench_acc_error(&acc, qr / 65536.0, fr);
+    }
+    bench_acc_report("q16_div", &acc, SAMPLES);
+}
+
+static void bench_q16_sqrt(void) {
+    bench_acc_t acc;
+    uint16_t c;
+
+    bench_acc_init(&acc);
+    for (uint8_t i = 0; i < SAMPLES; i++) {
+        double a = i * 3.1 + 0.5;
+        qa = Q16_FROM_FLOAT(a);
+        fa = a;
+        BENCH_CYCLES(c, qr = q16_sqrt(qa));
+        acc.fixed_cycles += c;
+        BENCH_CYCLES(c, fr = sqrt(fa));
+        acc.float_cycles += c;
+        bench_acc_error(&acc, qr / 65536.0, fr);
+    }
+    bench_acc_report("q16_sqrt", &acc, SAMPLES);
+}
+
+static void bench_fix_sin(void) {
+    bench_acc_t acc;
+    uint16_t c;
+
+    bench_acc_init(&acc);
+    for (uint8_t i = 0; i < SAMPLES; i++) {
+        uint16_t a = (uint16_t)i * 2048u + 123u;
+        angle = a;
+        fa = a * (2.0 * M_PI / 65536.0);
+        BENCH_CYCLES(c, sr = fix_sin(angle));
+        acc.fixed_cycles += c;
+        BENCH_CYCLES(c, fr = sin(fa));
+        acc.float_cycles += c;
+        bench_acc_error(&acc, sr / 32768.0, fr);
+    }
+    bench_acc_report("fix_sin", &acc, SAMPLES);
+}
+
+static void bench_q16_exp(void) {
+    bench_acc_t acc;
+    uint16_t c;
+
+    bench_acc_init(&acc);
+    for (uint8_t i = 0; i < SAMPLES; i++) {
+        double a = ((int8_t)i - 16) * 0.25 + 0.1;
+        qa = Q16_FROM_FLOAT(a);
+        fa = a;
+        BENCH_CYCLES(c, qr = q16_exp(qa));
+        acc.fixed_cycles += c;
+        BENCH_CYCLES(c, fr = exp(fa));
+        acc.float_cycles += c;
+        // relative error, the result spans several orders of magnitude
+        bench_acc_error(&acc, (qr / 65536.0) / fr, 1.0);
+    }
+    bench_acc_report("q16_exp (rel)", &acc, SAMPLES);
+}
+
+static void bench_q16_log(void) {
+    bench_acc_t acc;
+    uint16_t c;
+
+    bench_acc_init(&acc);
+    for (uint8_t i = 0; i < SAMPLES; i++) {
+        double a = i * 1.7 + 0.1;
+        qa = Q16_FROM_FLOAT(a);
+        fa = a;
+        BENCH_CYCLES(c, qr = q16_log(qa));
+        acc.fixed_cycles += c;
+        BENCH_CYCLES(c, fr = log(fa));
+        acc.float_cycles += c;
+        bench_acc_error(&acc, qr / 65536.0, fr);
+    }
+    bench_acc_report("q16_log", &acc, SAMPLES);
+}
+
+void bench_fixmath(void) {
+    bench_q16_mul();
+    bench_q15_mul();
+    bench_q16_div();
+    bench_q16_sqrt();
+    bench_fix_sin();
+    bench_q16_exp();
+    bench_q16_log();
+}
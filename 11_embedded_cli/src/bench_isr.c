@@ -0,0 +1,139 @@
+#include "bench.h"
+#include "events.h"
+#include "tick.h"
+#include "uart.h"
+#include "stdio.h"
+
+// Interrupt entry/exit cost, measured rather than counted. Timer2 raises a
+// compare interrupt every 256 cycles while a fixed busy loop runs; the
+// extra time the loop takes, divided by the number of interrupts taken, is
+// the full cost of one interrupt including the 4-cycle response, the JMP
+// in the vector table and reti.
+//
+//   COMPA: ISR_EVENT naked handler, sbi + reti
+//   COMPB: ordinary C handler incrementing a counter
+//
+// The project's own handlers, as built:
+//   tick (tick.c): the same busy loop with the 1 ms tick on, between two
+//     tick_millis() reads that count the interrupts taken, over TICK_RUNS
+//     runs.
+//   UART RX (uart.c): received bytes cannot be produced on demand without
+//     a wire from TX to RX, so the vector is called directly with
+//     interrupts off. The call (4 cycles) stands in for the interrupt
+//     response (4); the JMP in the vector slot (3) is added. The byte the
+//     handler stores is drained again, so input typed meanwhile is lost.
+
+#define ISR_PERIOD  256
+#define LOAD_LOOPS  2000
+#define TICK_RUNS   32
+#define RX_CALLS    16
+#define VECTOR_JMP  3
+
+#define STR_(x) #x
+#define STR(x)  STR_(x)
+
+// Enter a handler as the hardware would, minus the vector slot. It keeps
+// every register, so nothing is saved around the call; its reti sets I.
+#define CALL_VECTOR(vector) __asm__ __volatile__ ("call " STR(vector) ::: "memory")
+
+static volatile uint16_t isr_count;
+
+ISR_EVENT(TIMER2_COMPA_vect, EVENT_BENCH)
+
+ISR(TIMER2_COMPB_vect) {
+    isr_count++;
+}
+
+static void busy_loop(void) {
+    for (volatile uint16_t i = 0; i < LOAD_LOOPS; i++);
+}
+
+// Cycles taken by the busy loop with the given Timer2 interrupts enabled
+static uint16_t timed_load(uint8_t timsk) {
+    uint16_t c;
+
+    TCCR2A = (1 << WGM21);                  // CTC, TOP = OCR2A
+    OCR2A = ISR_PERIOD - 1;
+    OCR2B = ISR_PERIOD / 2;
+    TCNT2 = 0;
+    TIFR2 = (1 << OCF2A) | (1 << OCF2B);
+    TIMSK2 = timsk;
+    TCCR2B = (1 << CS20);                   // clk/1
+
+    BENCH_CYCLES(c, busy_loop());
+
+    TCCR2B = 0;
+    TIMSK2 = 0;
+    return c;
+}
+
+static void report(const char *name, uint16_t base, uint16_t loaded) {
+    uint16_t taken = loaded / ISR_PERIOD;
+    printf_P(PSTR("  %s: %u cy per interrupt (%u interrupts)\n"),
+           name, taken ? (loaded - base) / taken : 0, taken);
+}
+
+// Busy loop between two tick_millis() reads; 'ticks' is the number of
+// tick interrupts taken in between
+static uint16_t tick_load(uint16_t *ticks) {
+    uint32_t t0, t1;
+    uint16_t c;
+
+    BENCH_CYCLES(c, { t0 = tick_millis(); busy_loop(); t1 = tick_millis(); });
+    *ticks = t1 - t0;
+    return c;
+}
+
+// Tick interrupts on (TIMSK0 as tick_init() left it) against off
+static void bench_tick(uint8_t timsk0) {
+    uint32_t extra = 0;
+    uint16_t taken = 0, ticks;
+
+    TIMSK0 = 0;
+    uint16_t base = tick_load(&ticks);
+    TIMSK0 = timsk0;
+    for (uint8_t i = 0; i < TICK_RUNS; i++) {
+        uint16_t c = tick_load(&ticks);
+        if (c == CYCLES_OVERFLOW)
+            continue;
+        extra += c - base;
+        taken += ticks;
+    }
+    printf_P(PSTR("  tick handler: %lu cy per interrupt (%u interrupts)\n"),
+           taken ? extra / taken : 0, taken);
+}
+
+static void bench_uart_rx(void) {
+    uint32_t total = 0;
+    uint16_t c;
+
+    for (uint8_t i = 0; i < RX_CALLS; i++) {
+        cli();
+        BENCH_CYCLES(c, CALL_VECTOR(USART_RX_vect));
+        sei();
+        total += c;
+        while (uart_available())
+            uart_getc();
+    }
+    printf_P(PSTR("  UART RX handler: %lu cy per interrupt (called directly)\n"),
+           total / RX_CALLS + VECTOR_JMP);
+}
+
+void bench_isr(void) {
+    // keep the 1 ms tick out of the measurement
+    uint8_t timsk0 = TIMSK0;
+    TIMSK0 = 0;
+
+    uint16_t base = timed_load(0);
+    uint16_t flag = timed_load(1 << OCIE2A);
+    uint16_t counter = timed_load(1 << OCIE2B);
+    event_clear(EVENT_BENCH);
+
+    printf_P(PSTR("  busy loop: %u cy\n"), base);
+    report("ISR_EVENT (naked)", base, flag);
+    report("C handler", base, counter);
+
+    uart_flush();                   // no TX interrupt inside the timed call
+    bench_uart_rx();
+    bench_tick(timsk0);
+}
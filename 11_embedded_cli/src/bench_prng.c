@@ -0,0 +1,88 @@
+#include "bench.h"
+#include "prng.h"
+#include "adc.h"
+#include "stdio.h"
+
+// Integer generators against the float path they replace in
+// 03_software_pwm: a 16-bit xorshift normalised with a float divide, and
+// a float smoothing filter on top of it.
+
+#define SAMPLES 32
+
+static volatile uint16_t r16;
+static volatile uint32_t r32;
+static volatile uint8_t u8;
+static volatile float rf;
+
+static uint16_t float_seed = 0xACE1u;
+
+// The original rand_float()
+static float rand_float(void) {
+    float_seed ^= float_seed << 7;
+    float_seed ^= float_seed >> 9;
+    float_seed ^= float_seed << 8;
+    return (float)(float_seed & 0xFFFF) / 65535.0f;
+}
+
+// Time one generator call, averaged over SAMPLES calls
+#define BENCH_GENERATOR(name, stmt)                 \
+    do {                                            \
+        uint32_t total = 0;                         \
+        uint16_t c;                                 \
+        for (uint8_t i = 0; i < SAMPLES; i++) {     \
+            BENCH_CYCLES(c, stmt);                  \
+            total += c;                             \
+        }                                           \
+        printf_P(PSTR("  %s: %lu cy\n"), name, total / SAMPLES); \
+    } while (0)
+
+void bench_prng(void) {
+    prng16_t p16;
+    prng32_t p32;
+    prng64_t p64;
+    bench_acc_t acc;
+    uint16_t c;
+
+    prng16_seed(&p16, 1);
+    prng32_seed(&p32, 1);
+    prng64_seed(&p64, 1);
+
+    BENCH_GENERATOR("prng16_next", r16 = prng16_next(&p16));
+    BENCH_GENERATOR("prng32_next", r32 = prng32_next(&p32));
+    BENCH_GENERATOR("prng64_next", r32 = prng64_next(&p64));
+    BENCH_GENERATOR("prng16_range(6)", r16 = prng16_range(&p16, 6));
+    BENCH_GENERATOR("prng32_range(1000)", r16 = prng32_range(&p32, 1000));
+
+    // [0, 1): Q0.16 from the same xorshift16 sequence as rand_float()
+    bench_acc_init(&acc);
+    p16.s = float_seed;
+    for (uint8_t i = 0; i < SAMPLES; i++) {
+        BENCH_CYCLES(c, r16 = prng16_unit(&p16));
+        acc.fixed_cycles += c;
+        BENCH_CYCLES(c, rf = rand_float());
+        acc.float_cycles += c;
+        bench_acc_error(&acc, r16 / 65536.0, rf);
+    }
+    bench_acc_report("unit vs rand_float", &acc, SAMPLES);
+
+    // Smoothed noise: prev + (rand - prev) / 4, as uint8 and as float
+    uint8_t prev = 128;
+    float prev_f = 0.5f;
+    bench_acc_init(&acc);
+    for (uint8_t i = 0; i < SAMPLES; i++) {
+        BENCH_CYCLES(c, u8 = prev + (((int16_t)(prng16_next(&p16) >> 8) - prev) >> 2));
+        acc.fixed_cycles += c;
+        prev = u8;
+        BENCH_CYCLES(c, rf = prev_f + 0.25f * (rand_float() - prev_f));
+        acc.float_cycles += c;
+        prev_f = rf;
+    }
+    printf_P(PSTR("  smooth_rand: %lu cy, float %lu cy\n"),
+           acc.fixed_cycles / SAMPLES, acc.float_cycles / SAMPLES);
+
+    // the seed reprograms the ADC under the driver's conversion pipeline
+    if (adc_running())
+        printf_P(PSTR("  seed_from_adc: skipped, ADC in use (adc stop)\n"));
+    else
+        printf_P(PSTR("  seed_from_adc: 0x%lx\n"), prng_seed_from_adc());
+}
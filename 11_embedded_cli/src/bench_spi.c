@@ -0,0 +1,95 @@
+#include "bench.h"
+#include "uspi.h"
+#include "spi.h"
+#include "avr/io.h"
+#include "avr/interrupt.h"
+#include "stdio.h"
+#include "string.h"
+
+// Block output at SCK = F_CPU / 2 through the USART in master SPI mode and
+// through the SPI peripheral. One byte takes 16 cycles on the wire; the
+// USART's buffered transmitter keeps that pace, the SPI has to be polled
+// and reloaded after each byte. The block is all 0xFF so TXD, which the
+// USART drives as MOSI, stays at the UART idle level for the host.
+// Interrupts are off and the on-board LED (SCK, PB5) flickers.
+//
+// Then the SPI driver at each clock divider: one polled transfer of
+// SPI_POLL_MAX bytes and one queued, interrupt-driven transfer of
+// QUEUE_SIZE bytes. The queued figure includes the timer tick interrupt.
+
+#define BLOCK_SIZE 64
+#define QUEUE_SIZE 32               // 32 bytes at F_CPU / 128 fit in 16 bits
+
+static uint8_t block[BLOCK_SIZE];
+
+static void spi_write(const uint8_t *data, uint8_t len) {
+    while (len--) {
+        SPDR = *data++;
+        while (!(SPSR & (1 << SPIF)));
+    }
+}
+
+static void report(const char *name, uint16_t cycles, uint8_t bytes) {
+    printf_P(PSTR("  %s: %u cy for %u bytes, %u.%u cy/byte, %lu kB/s\n"),
+           name, cycles, bytes,
+           cycles / bytes, (uint16_t)((uint32_t)cycles * 10 / bytes % 10),
+           (uint32_t)F_CPU * bytes / 1000 / cycles);
+}
+
+static const uint8_t dividers[] = {
+    SPI_DIV2, SPI_DIV4, SPI_DIV8, SPI_DIV16, SPI_DIV32, SPI_DIV64, SPI_DIV128
+};
+
+static void bench_driver(void) {
+    static spi_transfer_t t;
+    uint16_t polled, queued;
+
+    uint8_t portb = PORTB;
+    spi_init();
+    for (uint8_t i = 0; i < sizeof(dividers); i++) {
+        uint8_t div = 2 << i;
+        t = (spi_transfer_t){ .clock = dividers[i], .tx = block };
+
+        t.len = SPI_POLL_MAX;
+        BENCH_CYCLES(polled, spi_submit(&t));
+        t.len = QUEUE_SIZE;
+        BENCH_CYCLES(queued, spi_submit(&t); spi_wait(&t));
+
+        printf_P(PSTR(" SCK = F_CPU / %u\n"), div);
+        report("polled", polled, SPI_POLL_MAX);
+        report("queued", queued, QUEUE_SIZE);
+    }
+    spi_end();
+    PORTB = portb;
+}
+
+void bench_spi(void) {
+    uint16_t usart, spi;
+    memset(block, 0xFF, sizeof(block));
+
+    uint8_t sreg = SREG;
+    cli();
+
+    uspi_begin(0, USPI_MODE0, false);
+    BENCH_CYCLES(usart, uspi_write(block, BLOCK_SIZE); uspi_flush());
+    uspi_end();
+
+    // SS (PB2), MOSI (PB3) and SCK (PB5) as outputs keep the SPI master
+    uint8_t ddrb = DDRB;
+    uint8_t portb = PORTB;
+    DDRB = ddrb | (1 << PB2) | (1 << PB3) | (1 << PB5);
+    SPCR = (1 << SPE) | (1 << MSTR);
+    SPSR = (1 << SPI2X);                    // clk/2
+    BENCH_CYCLES(spi, spi_write(block, BLOCK_SIZE));
+    SPCR = 0;
+    SPSR = 0;
+    PORTB = portb;
+    DDRB = ddrb;
+
+    SREG = sreg;
+
+    report("usart mspim", usart, BLOCK_SIZE);
+    report("spi", spi, BLOCK_SIZE);
+
+    bench_driver();
+}
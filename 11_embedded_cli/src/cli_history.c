@@ -0,0 +1,76 @@
+#include "cli_history.h"
+#include "eeprom.h"
+#include "crc16.h"
+#include "tick.h"
+#include "string.h"
+
+#define HEADER_SIZE   4
+#define HISTORY_MAGIC 0x48
+
+#if CLI_HISTORY_EEPROM_ADDR + CLI_HISTORY_EEPROM_SIZE > EEPROM_SIZE
+#error "CLI history area does not fit in the EEPROM"
+#endif
+
+static uint16_t history_size;       // 0: history is not saved
+static uint8_t header[HEADER_SIZE];
+static bool header_pending;         // data queued, header still to go
+static uint32_t last_input;
+static uint32_t last_save;
+
+// Covers the size as well, so a different CLI_HISTORY_SIZE starts empty
+static uint16_t history_crc(uint8_t count, const char *buf, uint16_t size) {
+    uint16_t crc = crc16_update(0xFFFF, (uint8_t)size);
+    crc = crc16_update(crc, count);
+    while (size--)
+        crc = crc16_update(crc, (uint8_t)*buf++);
+    return crc;
+}
+
+uint16_t cli_history_load(char *buf, uint16_t size) {
+    if (size > CLI_HISTORY_EEPROM_SIZE - HEADER_SIZE || size > EEPROM_QUEUE_SIZE)
+        return 0;
+    history_size = size;
+
+    uint8_t h[HEADER_SIZE];
+    eeprom_read(CLI_HISTORY_EEPROM_ADDR, h, sizeof(h));
+    if (h[0] != HISTORY_MAGIC)
+        return 0;
+    eeprom_read(CLI_HISTORY_EEPROM_ADDR + HEADER_SIZE, buf, size);
+    if (history_crc(h[1], buf, size) != (h[2] | (uint16_t)h[3] << 8)) {
+        memset(buf, 0, size);
+        return 0;
+    }
+    return h[1];
+}
+
+void cli_history_service(EmbeddedCli *cli, bool input) {
+    uint32_t now = tick_millis();
+    if (input)
+        last_input = now;
+
+    if (header_pending) {
+        if (eeprom_free() >= HEADER_SIZE) {
+            eeprom_write(CLI_HISTORY_EEPROM_ADDR, header, HEADER_SIZE);
+            header_pending = false;
+        }
+        return;
+    }
+
+    if (history_size == 0 || !embeddedCliHistoryChanged(cli) ||
+        now - last_input < CLI_HISTORY_IDLE_MS ||
+        now - last_save < CLI_HISTORY_INTERVAL_MS ||
+        eeprom_busy() || eeprom_free() < history_size)
+        return;
+
+    uint16_t count;
+    const char *buf = embeddedCliGetHistory(cli, &count);
+    eeprom_write(CLI_HISTORY_EEPROM_ADDR + HEADER_SIZE, buf, history_size);
+
+    uint16_t crc = history_crc(count, buf, history_size);
+    header[0] = HISTORY_MAGIC;
+    header[1] = count;
+    header[2] = crc & 0xFF;
+    header[3] = crc >> 8;
+    header_pending = true;
+    last_save = now;
+}
@@ -0,0 +1,40 @@
+#ifndef CLI_HISTORY_H
+#define CLI_HISTORY_H
+
+#include "embedded_cli.h"
+#include "kv.h"
+#include "stdint.h"
+#include "stdbool.h"
+
+// CLI command history kept in the EEPROM across resets, in the 64 bytes
+// above the KV store (kv.h). cli_history_load() is the CLI's historyLoad
+// hook; cli_history_service(), from the main loop, writes the history back
+//
+//   - only when it has changed (a repeated last command does not count),
+//   - only once the input has been idle for CLI_HISTORY_IDLE_MS,
+//   - at most once per CLI_HISTORY_INTERVAL_MS,
+//   - only when the EEPROM write queue is idle and has room, so it never
+//     waits; the driver then skips the bytes that are unchanged.
+//
+// At one save a minute the 100000-cycle endurance lasts for about 70 days
+// of non-stop typing. History of the last minute before a reset is lost.
+//
+// Layout: magic, item count, CRC-16 (2), history buffer. The history
+// buffer must fit both the area and the EEPROM write queue.
+
+#define CLI_HISTORY_EEPROM_ADDR (KV_EEPROM_START + KV_EEPROM_SIZE)
+#define CLI_HISTORY_EEPROM_SIZE 64
+
+#ifndef CLI_HISTORY_IDLE_MS
+#define CLI_HISTORY_IDLE_MS 5000
+#endif
+#ifndef CLI_HISTORY_INTERVAL_MS
+#define CLI_HISTORY_INTERVAL_MS 60000UL
+#endif
+
+uint16_t cli_history_load(char *buf, uint16_t size);
+
+// 'input': characters were received since the last call
+void cli_history_service(EmbeddedCli *cli, bool input);
+
+#endif // CLI_HISTORY_H
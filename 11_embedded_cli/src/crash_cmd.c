@@ -0,0 +1,70 @@
+#include "crash_cmd.h"
+#include "crash.h"
+#include "watchdog.h"
+#include "avr/interrupt.h"
+#include "stdio.h"
+#include "string.h"
+
+static void print_reset_cause(uint8_t cause) {
+    printf_P(PSTR("Reset cause: 0x%02x"), cause);
+    if (cause & (1 << PORF))  printf_P(PSTR(" power-on"));
+    if (cause & (1 << EXTRF)) printf_P(PSTR(" external"));
+    if (cause & (1 << BORF))  printf_P(PSTR(" brown-out"));
+    if (cause & (1 << WDRF))  printf_P(PSTR(" watchdog"));
+    printf_P(PSTR("\n"));
+}
+
+static void print_task(const char *prefix, uint8_t task) {
+    const char *name = watchdog_task_name(task);
+    printf_P(prefix);
+    if (name != NULL)
+        printf_P(PSTR("%s\n"), name);
+    else
+        printf_P(PSTR("%u\n"), task);
+}
+
+static void print_trace(const crash_record_t *r) {
+    printf_P(PSTR("Trace (oldest first):\n"));
+    for (uint8_t i = 0; i < CRASH_TRACE_SIZE; i++) {
+        const crash_trace_t *t = &r->trace[(r->trace_pos + i) & (CRASH_TRACE_SIZE - 1)];
+        switch (t->id) {
+            case CRASH_TRACE_BOOT:    printf_P(PSTR("  boot, cause 0x%02x\n"), t->arg); break;
+            case CRASH_TRACE_COMMAND: printf_P(PSTR("  command '%c'\n"), t->arg); break;
+            case CRASH_TRACE_FAULT:   printf_P(PSTR("  fault %u\n"), t->arg); break;
+            case CRASH_TRACE_OVERRUN: print_task(PSTR("  overrun, task "), t->arg); break;
+            case 0: break;          // unused slot
+            default: printf_P(PSTR("  event %u, 0x%02x\n"), t->id, t->arg); break;
+        }
+    }
+}
+
+void onCrash(EmbeddedCli *cli, char *args, void *context) {
+    (void)cli;
+    (void)context;
+
+    const char *action = embeddedCliGetToken(args, 1);
+    crash_trace(CRASH_TRACE_COMMAND, 'c');
+    if (action != NULL && strcmp(action, "test") == 0) {
+        printf_P(PSTR("Taking the unhandled interrupt path...\n"));
+        // same stack layout as a real interrupt: the call pushes the PC
+        cli();
+        __asm__ __volatile__ ("call __bad_interrupt");
+    }
+    if (action != NULL && strcmp(action, "hang") == 0) {
+        printf_P(PSTR("Hanging until the watchdog fires...\n"));
+        for (;;);
+    }
+
+    const crash_record_t *r = &crash_last;
+    print_reset_cause(r->reset_cause);
+    printf_P(PSTR("Resets since power-on: %u\n"), r->resets);
+    if (r->reason == CRASH_BAD_INTERRUPT)
+        printf_P(PSTR("Fault: unhandled interrupt at pc 0x%04x, sp 0x%04x\n"), r->pc, r->sp);
+    else if (r->reason == CRASH_WATCHDOG)
+        printf_P(PSTR("Fault: watchdog timeout at pc 0x%04x, sp 0x%04x\n"), r->pc, r->sp);
+    else
+        printf_P(PSTR("Fault: none\n"));
+    if (r->reason == CRASH_WATCHDOG && r->task != WATCHDOG_NO_TASK)
+        print_task(PSTR("Overdue task: "), r->task);
+    print_trace(r);
+}
@@ -0,0 +1,11 @@
+#ifndef CRASH_CMD_H
+#define CRASH_CMD_H
+
+#include "embedded_cli.h"
+
+// `crash` shows the post-mortem record of the run before the last reset
+// (see crash.h); `crash test` takes the unhandled-interrupt path on purpose,
+// `crash hang` stops the main loop so the watchdog supervisor fires.
+void onCrash(EmbeddedCli *cli, char *args, void *context);
+
+#endif // CRASH_CMD_H
@@ -0,0 +1,80 @@
+#include "kv_cmd.h"
+#include "kv.h"
+#include "crash.h"
+#include "watchdog.h"
+#include "stdio.h"
+#include "string.h"
+
+// Key number, -1 if not a valid key
+static int16_t parse_key(const char *s) {
+    if (s == NULL || *s == '\0')
+        return -1;
+    int16_t key = 0;
+    for (; *s; s++) {
+        if (*s < '0' || *s > '9')
+            return -1;
+        key = key * 10 + (*s - '0');
+        if (key >= KV_MAX_KEYS)
+            return -1;
+    }
+    return key;
+}
+
+// Print a value as text, '.' for anything not printable
+static bool print_value(uint8_t key) {
+    char value[KV_VALUE_MAX + 1];
+    int16_t len = kv_get(key, value, KV_VALUE_MAX);
+    if (len < 0)
+        return false;
+
+    for (int16_t i = 0; i < len; i++) {
+        if (value[i] < ' ' || value[i] > '~')
+            value[i] = '.';
+    }
+    value[len] = '\0';
+    printf_P(PSTR("  %u: %s\n"), key, value);
+    return true;
+}
+
+void onGet(EmbeddedCli *cli, char *args, void *context) {
+    (void)cli;
+    (void)context;
+    crash_trace(CRASH_TRACE_COMMAND, 'g');
+
+    const char *arg = embeddedCliGetToken(args, 1);
+    if (arg != NULL) {
+        int16_t key = parse_key(arg);
+        if (key < 0)
+            printf_P(PSTR("Usage: get [key], key 0..%u\n"), KV_MAX_KEYS - 1);
+        else if (!print_value(key))
+            printf_P(PSTR("  %u: not set\n"), key);
+        return;
+    }
+
+    for (uint8_t key = 0; key < KV_MAX_KEYS; key++) {
+        print_value(key);
+        watchdog_wait();
+    }
+
+    kv_info_t info;
+    kv_info(&info);
+    printf_P(PSTR("Live %u, log %u of %u bytes, generation %u\n"),
+           info.live, info.used, info.capacity, info.generation);
+}
+
+void onSet(EmbeddedCli *cli, char *args, void *context) {
+    (void)cli;
+    (void)context;
+    crash_trace(CRASH_TRACE_COMMAND, 's');
+
+    int16_t key = parse_key(embeddedCliGetToken(args, 1));
+    const char *value = embeddedCliGetToken(args, 2);
+    size_t len = value ? strlen(value) : 0;
+    if (key < 0 || len > KV_VALUE_MAX || embeddedCliGetToken(args, 3) != NULL) {
+        printf_P(PSTR("Usage: set <key> [value], key 0..%u, up to %u characters\n"),
+               KV_MAX_KEYS - 1, KV_VALUE_MAX);
+        return;
+    }
+    if (!kv_set(key, value, len))
+        printf_P(PSTR("Store full\n"));
+}
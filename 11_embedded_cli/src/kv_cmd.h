@@ -0,0 +1,13 @@
+#ifndef KV_CMD_H
+#define KV_CMD_H
+
+#include "embedded_cli.h"
+
+// `get` lists the keys of the EEPROM store (kv.h) with their values and
+// the store's usage, `get <key>` shows one value. `set <key> <value>`
+// stores a value (one word, or quoted), `set <key>` deletes the key.
+// Keys are numbers from 0 to KV_MAX_KEYS - 1; values are text.
+void onGet(EmbeddedCli *cli, char *args, void *context);
+void onSet(EmbeddedCli *cli, char *args, void *context);
+
+#endif // KV_CMD_H
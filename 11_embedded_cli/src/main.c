@@ -2,16 +2,41 @@
 #include "stddef.h"
 #include "uart.h"
 #include "output.h"
+#include "bench.h"
+#include "tick.h"
+#include "boot.h"
+#include "crash.h"
+#include "crash_cmd.h"
+#include "baud_cmd.h"
+#include "twi_cmd.h"
+#include "adc_cmd.h"
+#include "twi.h"
+#include "kv_cmd.h"
+#include "kv.h"
+#include "cli_history.h"
+#include "watchdog.h"
+#include "avr/wdt.h"
+#include "gpio.h"
+#include "string.h"
 
 #define EMBEDDED_CLI_IMPL
 #include "embedded_cli.h"
 
-// 164 bytes is minimum size for this params on Arduino Nano
-#define CLI_BUFFER_SIZE 166
+// 236 bytes is minimum size for this params on Arduino Nano
+#define CLI_BUFFER_SIZE 238
 #define CLI_RX_BUFFER_SIZE 16
 #define CLI_CMD_BUFFER_SIZE 32
 #define CLI_HISTORY_SIZE 32
-#define CLI_BINDING_COUNT 3
+#define CLI_BINDING_COUNT 9
+
+#define LED_PIN B, 5    // PB5, on-board LED (Arduino pin 13)
+
+// The main loop must come round at least this often. Commands that print
+// many lines (`bench`, `get`, `twi scan`) call watchdog_wait() as they go,
+// since at a low baud rate or with the host not reading, their output
+// alone can take longer.
+#define LOOP_DEADLINE_MS 1000
+#define LOOP_WDT_TIMEOUT WDTO_2S
 
 EmbeddedCli *cli;
 
@@ -25,17 +50,21 @@ void onHello(EmbeddedCli *cli, char *args, void *context);
 
 void onLed(EmbeddedCli *cli, char *args, void *context);
 
-void onAdc(EmbeddedCli *cli, char *args, void *context);
 
-
-// --- Main program ---
-int main(void) {
+// Called by crt0 before main with interrupts disabled, so printf works
+// from the first line of main
+void early_init(void) {
+    crash_init();
     uart_init();
-    
+    tick_init();
+
     // Set printf output to UART
     // Later, this can be changed to vga_putc for VGA output
     output_set_putc(uart_putc);
+}
 
+// --- Main program ---
+int main(void) {
     EmbeddedCliConfig *config = embeddedCliDefaultConfig();
     config->cliBuffer = cliBuffer;
     config->cliBufferSize = CLI_BUFFER_SIZE;
@@ -43,29 +72,153 @@ int main(void) {
     config->cmdBufferSize = CLI_CMD_BUFFER_SIZE;
     config->historyBufferSize = CLI_HISTORY_SIZE;
     config->maxBindingCount = CLI_BINDING_COUNT;
+    config->historyLoad = cli_history_load;
     cli = embeddedCliNew(config);
 
     if (cli == NULL) {
-        printf("Cli was not created. Check sizes!\n");
+        printf_P(PSTR("Cli was not created. Check sizes!\n"));
         return -1;
     }
-    printf("Cli has started. Enter your commands.\n");
+    cli->writeChar = writeChar;
+
+    CliCommandBinding benchBinding = {
+        "bench",
+        "Run benchmarks: bench [suite]",
+        true,
+        NULL,
+        onBench
+    };
+    embeddedCliAddBinding(cli, benchBinding);
+
+    CliCommandBinding ledBinding = {
+        "led",
+        "Control the on-board LED: led on|off|toggle",
+        true,
+        NULL,
+        onLed
+    };
+    embeddedCliAddBinding(cli, ledBinding);
+
+    CliCommandBinding crashBinding = {
+        "crash",
+        "Show the crash record of the last reset: crash [test|hang]",
+        true,
+        NULL,
+        onCrash
+    };
+    embeddedCliAddBinding(cli, crashBinding);
+
+    CliCommandBinding baudBinding = {
+        "baud",
+        "Show or set the UART rate: baud [auto|<rate>]",
+        true,
+        NULL,
+        onBaud
+    };
+    embeddedCliAddBinding(cli, baudBinding);
+
+    CliCommandBinding twiBinding = {
+        "twi",
+        "TWI statistics and bus scan: twi [scan [100|400]|clear]",
+        true,
+        NULL,
+        onTwi
+    };
+    embeddedCliAddBinding(cli, twiBinding);
+
+    CliCommandBinding getBinding = {
+        "get",
+        "Show stored settings: get [key]",
+        true,
+        NULL,
+        onGet
+    };
+    embeddedCliAddBinding(cli, getBinding);
+
+    CliCommandBinding setBinding = {
+        "set",
+        "Store a setting in EEPROM, no value deletes it: set <key> [value]",
+        true,
+        NULL,
+        onSet
+    };
+    embeddedCliAddBinding(cli, setBinding);
+
+    CliCommandBinding adcBinding = {
+        "adc",
+        "Sample analog inputs in the background: adc [start <channels> [bits]|scan <channels> [ms]|stop]",
+        true,
+        NULL,
+        onAdc
+    };
+    embeddedCliAddBinding(cli, adcBinding);
+
+    CliCommandBinding fftBinding = {
+        "fft",
+        "Strongest tones of an analog input sampled at 1 kHz: fft [64|128|256] [channel]",
+        true,
+        ADC_CMD_FFT,
+        onAdc
+    };
+    embeddedCliAddBinding(cli, fftBinding);
+    gpio_output(LED_PIN);
+    kv_init();
+
+    uint8_t loopTask = watchdog_register("loop", LOOP_DEADLINE_MS);
+    watchdog_start(LOOP_WDT_TIMEOUT);
+    boot_ready();
+    printf_P(PSTR("Cli has started. Enter your commands.\n"));
 
  
 
 
     // --- Test Cases ---
-    printf("Char: %c, String: %s\n", 'A', "Hello World");
-    printf("Int: %+05d, UInt: %u\n", -123, 456);
+    printf_P(PSTR("Char: %c, String: %s\n"), 'A', "Hello World");
+    printf_P(PSTR("Int: %+05d, UInt: %u\n"), -123, 456);
     long big_num = 2147483648L;
-    printf("Long: %ld\n", big_num);
+    printf_P(PSTR("Long: %ld\n"), big_num);
     int val = 255;
-    printf("Hex: %#x, Octal: %#o, Pointer: %p\n", val, val, &val);
+    printf_P(PSTR("Hex: %#x, Octal: %#o, Pointer: %p\n"), val, val, &val);
 
     double pi = 3.14159265;
     double small = 0.0001234;
-    printf("Float: %.4f, Sci: %.3e\n", pi, small);
-
-    while (1) { }
+    printf_P(PSTR("Float: %.4f, Sci: %.3e\n"), pi, small);
+
+    while (1) {
+        watchdog_checkin(loopTask);
+
+        // Feed received characters to the CLI, no more than its rx fifo
+        // holds (one slot stays free), then run any complete command. The
+        // rest waits in the UART buffer, whose watermarks pause the host.
+        uint8_t n = 0;
+        for (; n < CLI_RX_BUFFER_SIZE - 1 && uart_available(); n++)
+            embeddedCliReceiveChar(cli, uart_getc());
+        embeddedCliProcess(cli);
+        twi_poll();
+        cli_history_service(cli, n > 0);
+
+        watchdog_service();
+    }
     return 0;
 }
+
+void writeChar(EmbeddedCli *embeddedCli, char c) {
+    (void)embeddedCli;
+    uart_putc(c);
+}
+
+void onLed(EmbeddedCli *cli, char *args, void *context) {
+    (void)cli;
+    (void)context;
+    crash_trace(CRASH_TRACE_COMMAND, 'l');
+
+    const char *action = embeddedCliGetToken(args, 1);
+    if (action == NULL || strcmp(action, "toggle") == 0)
+        gpio_toggle(LED_PIN);
+    else if (strcmp(action, "on") == 0)
+        gpio_set(LED_PIN);
+    else if (strcmp(action, "off") == 0)
+        gpio_clear(LED_PIN);
+    else
+        printf_P(PSTR("Usage: led on|off|toggle\n"));
+}
@@ -0,0 +1,77 @@
+#include "twi_cmd.h"
+#include "twi.h"
+#include "crash.h"
+#include "watchdog.h"
+#include "stdio.h"
+#include "string.h"
+
+// 7-bit addresses outside the reserved groups
+#define ADDR_FIRST 0x08
+#define ADDR_LAST  0x77
+
+static void print_stats(void) {
+    twi_stats_t s;
+    twi_stats(&s);
+
+    uint16_t failed = 0;
+    for (uint8_t i = TWI_OK + 1; i <= TWI_TIMEOUT; i++)
+        failed += s.errors[i];
+    uint16_t ok = s.count - failed;
+
+    printf_P(PSTR("Transactions: %u ok, %u failed, %lu bytes\n"), ok, failed, s.bytes);
+    if (ok)
+        printf_P(PSTR("Time: min %u us, avg %lu us, max %u us\n"),
+               s.min_us, s.total_us / ok, s.max_us);
+    printf_P(PSTR("NACK address %u, NACK data %u, arbitration lost %u, bus error %u, timeout %u\n"),
+           s.errors[TWI_NACK_ADDR], s.errors[TWI_NACK_DATA], s.errors[TWI_ARB_LOST],
+           s.errors[TWI_BUS_ERROR], s.errors[TWI_TIMEOUT]);
+}
+
+static void scan(uint8_t twbr) {
+    twi_transfer_t probe = { 0 };
+    uint8_t found = 0;
+
+    twi_init(twbr);
+    for (uint8_t addr = ADDR_FIRST; addr <= ADDR_LAST; addr++) {
+        probe.address = addr;
+        twi_submit(&probe);
+        uint8_t status = twi_wait(&probe);
+        if (status == TWI_OK) {
+            printf_P(PSTR("  0x%02x: %u us\n"), addr, probe.micros);
+            found++;
+        } else if (status != TWI_NACK_ADDR) {
+            printf_P(PSTR("  0x%02x: error %u, scan stopped\n"), addr, status);
+            break;
+        }
+        watchdog_wait();
+    }
+    printf_P(PSTR("%u device(s)\n"), found);
+}
+
+void onTwi(EmbeddedCli *cli, char *args, void *context) {
+    (void)cli;
+    (void)context;
+    crash_trace(CRASH_TRACE_COMMAND, 't');
+
+    const char *action = embeddedCliGetToken(args, 1);
+    if (action == NULL) {
+        print_stats();
+        return;
+    }
+    if (strcmp(action, "clear") == 0) {
+        twi_stats_clear();
+        return;
+    }
+    if (strcmp(action, "scan") == 0) {
+        const char *speed = embeddedCliGetToken(args, 2);
+        if (speed == NULL || strcmp(speed, "100") == 0) {
+            scan(TWI_TWBR(100000));
+            return;
+        }
+        if (strcmp(speed, "400") == 0) {
+            scan(TWI_TWBR(400000));
+            return;
+        }
+    }
+    printf_P(PSTR("Usage: twi [scan [100|400]|clear]\n"));
+}
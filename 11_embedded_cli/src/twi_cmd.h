@@ -0,0 +1,11 @@
+#ifndef TWI_CMD_H
+#define TWI_CMD_H
+
+#include "embedded_cli.h"
+
+// `twi` shows the transaction statistics of the TWI driver (twi.h),
+// `twi scan [100|400]` probes every address at 100 or 400 kHz and lists
+// the devices that answer, `twi clear` resets the statistics.
+void onTwi(EmbeddedCli *cli, char *args, void *context);
+
+#endif // TWI_CMD_H
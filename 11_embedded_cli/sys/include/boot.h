@@ -0,0 +1,39 @@
+#ifndef BOOT_H
+#define BOOT_H
+
+// Boot latency, measured on every start. crt0 starts Timer1 at clk/1 as its
+// first instruction and stores the count just before calling main; the
+// Timer1 overflow interrupt extends it to 32 bits until boot_ready() stops
+// it, so the CLI-ready figure may include slow UART output.
+//
+// Timer1 is free for other users (cycles.h) once boot_ready() has run.
+//
+// crt0.S includes this header for BOOT_START_CYCLES; the C declarations
+// are guarded by __ASSEMBLER__.
+
+// Cycles spent before Timer1 starts: the reset JMP, ldi and sts
+#define BOOT_START_CYCLES 6
+
+#ifndef __ASSEMBLER__
+
+#include "stdint.h"
+
+// MCUSR at reset (PORF/EXTRF/BORF/WDRF bits), saved by crt0 before clearing it
+extern uint8_t boot_reset_cause;
+
+// Reset to main(), including early_init(); 0xFFFF if Timer1 wrapped first
+extern uint16_t boot_main_cycles;
+
+// Reset to boot_ready(), 0 until it has been called
+extern uint32_t boot_ready_cycles;
+
+// Board setup run by crt0 after .data/.bss init, before main() and with
+// interrupts still disabled. Weak default does nothing.
+void early_init(void);
+
+// Mark the application ready (e.g. CLI accepting input) and release Timer1
+void boot_ready(void);
+
+#endif // __ASSEMBLER__
+
+#endif // BOOT_H
@@ -0,0 +1,65 @@
+#ifndef CRASH_H
+#define CRASH_H
+
+#include "stdint.h"
+
+// Post-mortem record kept in .noinit, which crt0 does not clear, so it
+// survives a watchdog or external reset (not a power cycle). It holds:
+//
+//   - the reset cause (MCUSR) and the number of resets since power-on
+//   - why the firmware reset itself and where: the interrupted PC and SP
+//     on an unhandled interrupt or a watchdog timeout, and for a timeout
+//     the supervised task that missed its deadline (watchdog.h)
+//   - the last CRASH_TRACE_SIZE trace entries written with crash_trace()
+//
+// crash_init() copies the record left by the previous run to crash_last
+// and starts a fresh one, so the CLI `crash` command can show what led to
+// the current reset while new trace entries are collected.
+
+#define CRASH_MAGIC       0xC0DE
+#define CRASH_TRACE_SIZE  8         // power of two
+
+// Why the firmware reset itself (crash_fault reason)
+#define CRASH_NONE           0
+#define CRASH_BAD_INTERRUPT  1      // also hard-coded in crt0.S
+#define CRASH_WATCHDOG       2
+
+// Trace entry ids
+#define CRASH_TRACE_BOOT     1      // arg: reset cause
+#define CRASH_TRACE_COMMAND  2      // arg: first letter of the command
+#define CRASH_TRACE_FAULT    3      // arg: crash reason
+#define CRASH_TRACE_OVERRUN  4      // arg: watchdog task id
+
+typedef struct {
+    uint8_t id;
+    uint8_t arg;
+} crash_trace_t;
+
+typedef struct {
+    uint16_t magic;
+    uint16_t resets;                // resets since power-on
+    uint8_t reset_cause;            // MCUSR of the reset that ended this run
+    uint8_t reason;                 // CRASH_*
+    uint16_t pc;                    // byte address of the interrupted instruction
+    uint16_t sp;                    // stack pointer before the interrupt
+    uint8_t task;                   // overdue watchdog task, WATCHDOG_NO_TASK if none
+    uint8_t trace_pos;              // next trace slot
+    crash_trace_t trace[CRASH_TRACE_SIZE];
+} crash_record_t;
+
+// Record of the run before the last reset, valid after crash_init()
+extern crash_record_t crash_last;
+
+// Take over the record of the previous run and start a new one. Call once
+// at startup, after crt0 has saved the reset cause.
+void crash_init(void);
+
+// Append an entry to the trace ring. Safe from interrupts.
+void crash_trace(uint8_t id, uint8_t arg);
+
+// Record a fault and reset through the watchdog. 'sp' is the stack pointer
+// as read on entry to an interrupt handler: the interrupted PC sits just
+// above it. Called with interrupts disabled.
+void crash_fault(uint8_t reason, uint16_t sp) __attribute__((noreturn));
+
+#endif // CRASH_H
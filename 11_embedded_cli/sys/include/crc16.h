@@ -0,0 +1,16 @@
+#ifndef CRC16_H
+#define CRC16_H
+
+#include "stdint.h"
+
+// CRC-16/CCITT (polynomial 0x1021, start with 0xFFFF), bit by bit: used
+// for short EEPROM records that are written far less often than a lookup
+// table would cost in flash
+static inline uint16_t crc16_update(uint16_t crc, uint8_t b) {
+    crc ^= (uint16_t)b << 8;
+    for (uint8_t i = 0; i < 8; i++)
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    return crc;
+}
+
+#endif // CRC16_H
@@ -0,0 +1,40 @@
+#ifndef CYCLES_H
+#define CYCLES_H
+
+#include "avr/io.h"
+#include "stdint.h"
+
+// Cycle counter built on Timer1 running at the CPU clock (no prescaler).
+// Measures up to 65535 cycles; longer sections report CYCLES_OVERFLOW.
+// Timer1 is reconfigured, so do not use while another driver owns it.
+//
+// Usage:
+//   cycles_start();
+//   do_work();
+//   uint16_t n = cycles_stop();
+//
+// The count includes the few cycles between starting the timer and reading
+// it back; measure an empty start/stop pair once and subtract it when
+// exact numbers matter (the bench command does this).
+
+#define CYCLES_OVERFLOW 0xFFFFu
+
+static inline __attribute__((always_inline)) void cycles_start(void) {
+    TCCR1B = 0;                 // stop the timer
+    TCCR1A = 0;                 // normal mode
+    TCNT1 = 0;
+    TIFR1 = (1 << TOV1);        // clear overflow flag (write 1 to clear)
+    __asm__ __volatile__ ("" ::: "memory");
+    TCCR1B = (1 << CS10);       // start at clk/1
+}
+
+static inline __attribute__((always_inline)) uint16_t cycles_stop(void) {
+    __asm__ __volatile__ ("" ::: "memory");
+    uint16_t count = TCNT1;
+    TCCR1B = 0;
+    if (TIFR1 & (1 << TOV1))
+        return CYCLES_OVERFLOW;
+    return count;
+}
+
+#endif // CYCLES_H
@@ -0,0 +1,99 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include "avr/io.h"
+#include "avr/interrupt.h"
+#include "stdbool.h"
+
+// Event flags for ISR -> main loop signalling, one bit of GPIOR0 each.
+//
+// GPIOR0 is bit-addressable, so setting a flag is a single sbi: no CPU
+// register and no SREG change. A handler that only raises a flag therefore
+// needs no prologue or epilogue at all (see ISR_EVENT below), and the main
+// loop tests and clears flags with sbic/cbi just as cheaply.
+//
+// Bits are allocated here so drivers cannot collide.
+#define EVENT_TICK      0   // 1 ms system tick (tick.c)
+#define EVENT_UART_RX   1   // byte(s) added to the UART receive buffer
+#define EVENT_ADC_FRAME 2   // scan frame completed (adc.c)
+#define EVENT_BENCH     7   // reserved for the bench command
+
+// The bit number must be a compile-time constant (it is encoded in the
+// instruction), which always_inline guarantees after constant propagation.
+static inline __attribute__((always_inline)) void event_set(uint8_t bit) {
+    __asm__ __volatile__ ("sbi %0, %1" :: "I" (_SFR_IO_ADDR(GPIOR0)), "I" (bit) : "memory");
+}
+
+static inline __attribute__((always_inline)) void event_clear(uint8_t bit) {
+    __asm__ __volatile__ ("cbi %0, %1" :: "I" (_SFR_IO_ADDR(GPIOR0)), "I" (bit) : "memory");
+}
+
+static inline __attribute__((always_inline)) bool event_pending(uint8_t bit) {
+    uint8_t r;
+    __asm__ __volatile__ (
+        "clr  %0"      "\n\t"
+        "sbic %1, %2"  "\n\t"
+        "inc  %0"
+        : "=r" (r)
+        : "I" (_SFR_IO_ADDR(GPIOR0)), "I" (bit)
+        : "memory"
+    );
+    return r;
+}
+
+// Test and clear in one go. Raising the same event again between the test
+// and the clear merges with the one being taken, as flags do.
+static inline __attribute__((always_inline)) bool event_take(uint8_t bit) {
+    uint8_t r;
+    __asm__ __volatile__ (
+        "clr  %0"      "\n\t"
+        "sbis %1, %2"  "\n\t"
+        "rjmp 1f"      "\n\t"
+        "cbi  %1, %2"  "\n\t"
+        "inc  %0"      "\n"
+        "1:"
+        : "=r" (r)
+        : "I" (_SFR_IO_ADDR(GPIOR0)), "I" (bit)
+        : "memory"
+    );
+    return r;
+}
+
+// Naked handler that only raises an event: sbi + reti, 13 cycles from
+// interrupt to return. Only for sources whose interrupt flag the hardware
+// clears when the vector runs (timer compare/overflow, INTx, PCINTx, ADC,
+// EE_READY). USART RX/UDRE and TWI keep firing until their data or control
+// register is serviced and cannot use this.
+#define ISR_EVENT(vector, bit)                                  \
+    ISR(vector, ISR_NAKED) {                                    \
+        __asm__ __volatile__ (                                  \
+            "sbi %0, %1"  "\n\t"                                \
+            "reti"                                              \
+            :: "I" (_SFR_IO_ADDR(GPIOR0)), "I" (bit)            \
+        );                                                      \
+    }
+
+// Naked handler that copies one data register into GPIOR2 and raises an
+// event, for sources cleared by reading their data register (USART RX,
+// SPI). r24 is parked in GPIOR1 instead of on the stack; in/out/lds do not
+// touch SREG, so nothing else needs saving. 18 cycles from interrupt to
+// return. GPIOR2 holds only the latest byte: the main loop must read it
+// before the next interrupt.
+#define ISR_EVENT_BYTE(vector, bit, data_reg)                   \
+    ISR(vector, ISR_NAKED) {                                    \
+        __asm__ __volatile__ (                                  \
+            "out %[save], r24"  "\n\t"                          \
+            "lds r24, %[data]"  "\n\t"                          \
+            "out %[box], r24"   "\n\t"                          \
+            "sbi %[flags], %[b]" "\n\t"                         \
+            "in  r24, %[save]"  "\n\t"                          \
+            "reti"                                              \
+            :: [save] "I" (_SFR_IO_ADDR(GPIOR1)),               \
+               [box] "I" (_SFR_IO_ADDR(GPIOR2)),                \
+               [flags] "I" (_SFR_IO_ADDR(GPIOR0)),              \
+               [data] "n" ((uint16_t)&(data_reg)),              \
+               [b] "I" (bit)                                    \
+        );                                                      \
+    }
+
+#endif // EVENTS_H
@@ -0,0 +1,71 @@
+#ifndef KV_H
+#define KV_H
+
+#include "stdint.h"
+#include "stdbool.h"
+
+// Key/value store in the EEPROM, written as a log. Setting a key appends a
+// record instead of rewriting a fixed cell, so frequently changed values
+// spread their wear over the whole area, and a RAM index of the newest
+// record per key makes a read one lookup plus the value bytes.
+//
+// The area is split in two banks; one is active at a time:
+//
+//   header: magic, generation (2), CRC-16 (2)
+//   record: key, length, value (length bytes), CRC-16 (2)
+//   ...
+//
+// The record CRC covers the bank generation too (not stored), so records
+// left over from an earlier use of the bank fail the check and end the log
+// just like erased cells. A full bank is compacted into the other one:
+// the newest record of each key is copied, and the new header, with the
+// next generation, is written only once the copies are programmed.
+//
+// Power loss: a record cut short fails its CRC and is dropped, along with
+// nothing before it; a compaction cut short leaves the new bank without a
+// valid header, so the old one stays active. Writes go through the
+// EEPROM queue (eeprom.h): a set is durable once eeprom_busy() is false.
+// tools/kv_powerfail.py checks this on the host with writes cut at
+// random bytes.
+
+// Keys are 0 .. KV_MAX_KEYS - 1; the index takes 2 bytes of SRAM per key
+#ifndef KV_MAX_KEYS
+#define KV_MAX_KEYS 32
+#endif
+
+#ifndef KV_VALUE_MAX
+#define KV_VALUE_MAX 32
+#endif
+
+// EEPROM area, both banks. The top 64 bytes are left for other users.
+#ifndef KV_EEPROM_START
+#define KV_EEPROM_START 0
+#endif
+#ifndef KV_EEPROM_SIZE
+#define KV_EEPROM_SIZE 960
+#endif
+
+typedef struct {
+    uint16_t generation;            // compactions so far (plus one)
+    uint16_t capacity;              // record bytes per bank
+    uint16_t used;                  // bytes of log in the active bank
+    uint16_t live;                  // bytes of the newest record per key
+} kv_info_t;
+
+// Find the active bank and build the index; formats an empty store if
+// neither bank is valid
+void kv_init(void);
+
+// Copy up to 'size' bytes of the value of 'key' to 'value' and return
+// its full length, or -1 if the key is not set
+int16_t kv_get(uint8_t key, void *value, uint8_t size);
+
+// Set 'key'; length 0 deletes it. Setting the value a key already has
+// writes nothing. May compact, which holds up the caller while up to a
+// bank of records is programmed (the watchdog is kept fed). False for a
+// bad key or length, or when the live records would not fit.
+bool kv_set(uint8_t key, const void *value, uint8_t len);
+
+void kv_info(kv_info_t *info);
+
+#endif // KV_H
@@ -2,7 +2,9 @@
 #define STDIO_H
 
 #include "output.h"
+#include "pgmspace.h"
 #include "stdint.h"
+#include "stdbool.h"
 #include "stddef.h"
 
 // Forward declarations for printf helper functions
@@ -16,6 +18,9 @@ void stdio_print_scientific(output_putc_t putc, double val, int precision, char
 // Main printf function
 void printf(const char *fmt, ...);
 
+// printf with the format string in flash: printf_P(PSTR("..."), ...)
+void printf_P(const char *fmt, ...);
+
 // sprintf function - writes formatted string to buffer
 int sprintf(char *str, const char *fmt, ...);
 
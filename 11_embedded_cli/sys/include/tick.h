@@ -0,0 +1,18 @@
+#ifndef TICK_H
+#define TICK_H
+
+#include "stdint.h"
+
+// 1 ms system tick on Timer0 (CTC, clk/64, OCR0A = 249). Each tick bumps
+// the millisecond counter and raises EVENT_TICK (see events.h).
+
+void tick_init(void);
+
+// Milliseconds since tick_init(), wraps after ~49.7 days
+uint32_t tick_millis(void);
+
+// Microseconds since tick_init() in steps of one Timer0 count (4 us at
+// 16 MHz), wraps after ~71.6 minutes. Safe to call from interrupts.
+uint32_t tick_micros(void);
+
+#endif // TICK_H
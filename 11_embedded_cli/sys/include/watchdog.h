@@ -0,0 +1,59 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include "stdint.h"
+
+// Watchdog supervisor for the main loop. Each task registers a deadline
+// and must call watchdog_checkin() at least that often; watchdog_service(),
+// called once per main loop pass, only kicks the hardware watchdog while
+// every task is on time.
+//
+// The watchdog runs in interrupt-then-reset mode: when it is not kicked
+// the WDT interrupt fires first and crash.c records the interrupted PC
+// and the first overdue task (watchdog_overdue()) before the reset. This
+// also catches a main loop stuck outside watchdog_service(), e.g. in a
+// blocking UART wait.
+//
+// Usage:
+//   uint8_t loop = watchdog_register("loop", 1000);
+//   watchdog_start(WDTO_2S);
+//   while (1) {
+//       watchdog_checkin(loop);
+//       ...
+//       watchdog_service();
+//   }
+//
+// Deadlines are checked against tick_millis(), so they must be shorter
+// than the watchdog timeout to be reported as overruns, and at most
+// 32767 ms. Register outer tasks first: when several are overdue (the
+// whole loop is stuck), the first one registered is blamed.
+
+#define WATCHDOG_MAX_TASKS  4
+#define WATCHDOG_NO_TASK    0xFF
+
+// Add a task, returns its id or WATCHDOG_NO_TASK if the table is full.
+// 'name' must stay valid; it is used by the `crash` command after a reset,
+// so register tasks in the same order on every boot.
+uint8_t watchdog_register(const char *name, uint16_t deadline_ms);
+
+// Report that a task is alive. Safe from interrupts.
+void watchdog_checkin(uint8_t task);
+
+// Start all deadlines from now and enable the watchdog (WDTO_* timeout)
+void watchdog_start(uint8_t timeout);
+
+// Kick the watchdog if no task is overdue
+void watchdog_service(void);
+
+// For code that holds up the main loop on purpose, with its own timeout
+// (e.g. waiting for input): check in every task and kick the watchdog.
+// Call at least once per task deadline while waiting.
+void watchdog_wait(void);
+
+// First overdue task, or WATCHDOG_NO_TASK
+uint8_t watchdog_overdue(void);
+
+// Name given to watchdog_register(), NULL for an unknown id
+const char *watchdog_task_name(uint8_t task);
+
+#endif // WATCHDOG_H
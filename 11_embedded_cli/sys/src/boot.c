@@ -0,0 +1,31 @@
+#include "boot.h"
+#include "avr/io.h"
+#include "avr/interrupt.h"
+
+uint8_t boot_reset_cause;               // written by crt0
+uint16_t boot_main_cycles;              // written by crt0
+uint32_t boot_ready_cycles;
+
+static volatile uint16_t boot_overflows;
+
+ISR(TIMER1_OVF_vect) {
+    boot_overflows++;
+}
+
+void boot_ready(void) {
+    uint8_t sreg = SREG;
+    cli();
+
+    uint16_t count = TCNT1;
+    uint16_t overflows = boot_overflows;
+    // an overflow that happened after cli() has not been counted yet
+    if ((TIFR1 & (1 << TOV1)) && count < 0x8000)
+        overflows++;
+
+    TCCR1B = 0;
+    TIMSK1 = 0;
+    TIFR1 = (1 << TOV1);
+    SREG = sreg;
+
+    boot_ready_cycles = ((uint32_t)overflows << 16) + count + BOOT_START_CYCLES;
+}
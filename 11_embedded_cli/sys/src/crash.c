@@ -0,0 +1,74 @@
+#include "crash.h"
+#include "boot.h"
+#include "watchdog.h"
+#include "avr/io.h"
+#include "avr/interrupt.h"
+#include "avr/wdt.h"
+#include "string.h"
+
+static crash_record_t crash_record __attribute__((section(".noinit")));
+crash_record_t crash_last;
+
+void crash_init(void) {
+    uint8_t cause = boot_reset_cause;
+
+    // garbage after power-up: start from scratch
+    if (crash_record.magic != CRASH_MAGIC || (cause & (1 << PORF))) {
+        memset(&crash_record, 0, sizeof(crash_record));
+        crash_record.magic = CRASH_MAGIC;
+    }
+
+    crash_record.reset_cause = cause;
+    crash_last = crash_record;
+
+    crash_record.resets++;
+    crash_record.reason = CRASH_NONE;
+    crash_record.pc = 0;
+    crash_record.sp = 0;
+    crash_record.task = WATCHDOG_NO_TASK;
+    crash_record.trace_pos = 0;
+    memset(crash_record.trace, 0, sizeof(crash_record.trace));
+
+    crash_trace(CRASH_TRACE_BOOT, cause);
+}
+
+void crash_trace(uint8_t id, uint8_t arg) {
+    uint8_t sreg = SREG;
+    cli();
+    uint8_t pos = crash_record.trace_pos;
+    crash_record.trace[pos].id = id;
+    crash_record.trace[pos].arg = arg;
+    crash_record.trace_pos = (pos + 1) & (CRASH_TRACE_SIZE - 1);
+    SREG = sreg;
+}
+
+void crash_fault(uint8_t reason, uint16_t sp) {
+    // the interrupt pushed the return address high byte last: it is at
+    // sp + 1, the low byte at sp + 2, and it is a word address
+    const uint8_t *stack = (const uint8_t *)sp;
+    crash_record.pc = ((uint16_t)stack[1] << 8 | stack[2]) * 2;
+    crash_record.sp = sp + 2;
+    crash_record.reason = reason;
+    if (reason == CRASH_WATCHDOG)
+        crash_record.task = watchdog_overdue();
+    crash_trace(CRASH_TRACE_FAULT, reason);
+
+    wdt_enable(WDTO_15MS);
+    for (;;);
+}
+
+// Watchdog timeout in interrupt mode (wdt_enable_irq): record where the
+// firmware was stuck, and which supervised task overran, before the reset
+// that follows. Naked, so the stack
+// pointer seen here is the one the interrupt left.
+ISR(WDT_vect, ISR_NAKED) {
+    __asm__ __volatile__ (
+        "clr  r1"       "\n\t"
+        "in   r22, %0"  "\n\t"
+        "in   r23, %1"  "\n\t"
+        "ldi  r24, %2"  "\n\t"
+        "jmp  crash_fault"
+        :
+        : "I" (_SFR_IO_ADDR(SPL)), "I" (_SFR_IO_ADDR(SPH)), "M" (CRASH_WATCHDOG)
+    );
+}
@@ -0,0 +1,210 @@
+#include "kv.h"
+#include "eeprom.h"
+#include "watchdog.h"
+#include "crc16.h"
+#include "string.h"
+
+#define BANK_SIZE       (KV_EEPROM_SIZE / 2)
+#define HEADER_SIZE     5
+#define RECORD_OVERHEAD 4           // key, length, CRC
+#define KV_MAGIC        0xA5
+
+#if KV_EEPROM_START + KV_EEPROM_SIZE > EEPROM_SIZE
+#error "KV area does not fit in the EEPROM"
+#endif
+#if KV_VALUE_MAX > EEPROM_QUEUE_SIZE || KV_VALUE_MAX > 255
+#error "KV_VALUE_MAX must fit in the EEPROM write queue"
+#endif
+#if KV_MAX_KEYS > 255
+#error "KV_MAX_KEYS must fit in 8 bits"
+#endif
+
+// EEPROM address of the newest record of each key, 0 if not set (never a
+// record address: the bank header comes first)
+static uint16_t latest[KV_MAX_KEYS];
+static uint16_t bank;               // start of the active bank
+static uint16_t generation;
+static uint16_t end;                // where the next record goes
+
+static uint16_t record_crc(uint16_t gen, uint8_t key, const uint8_t *value, uint8_t len) {
+    uint16_t crc = crc16_update(crc16_update(0xFFFF, gen & 0xFF), gen >> 8);
+    crc = crc16_update(crc16_update(crc, key), len);
+    while (len--)
+        crc = crc16_update(crc, *value++);
+    return crc;
+}
+
+// Queue EEPROM writes; while the queue is full the main loop is held up,
+// so keep its watchdog tasks checked in
+static void store(uint16_t addr, const void *data, uint8_t len) {
+    while (eeprom_free() < len)
+        watchdog_wait();
+    eeprom_write(addr, data, len);
+}
+
+static bool header_valid(uint16_t base, uint16_t *gen) {
+    uint8_t h[HEADER_SIZE];
+    eeprom_read(base, h, sizeof(h));
+    if (h[0] != KV_MAGIC)
+        return false;
+    uint16_t crc = crc16_update(crc16_update(crc16_update(0xFFFF, h[0]), h[1]), h[2]);
+    if (crc != (h[3] | (uint16_t)h[4] << 8))
+        return false;
+    *gen = h[1] | (uint16_t)h[2] << 8;
+    return true;
+}
+
+static void write_header(uint16_t base, uint16_t gen) {
+    uint8_t h[HEADER_SIZE] = { KV_MAGIC, gen & 0xFF, gen >> 8 };
+    uint16_t crc = crc16_update(crc16_update(crc16_update(0xFFFF, h[0]), h[1]), h[2]);
+    h[3] = crc & 0xFF;
+    h[4] = crc >> 8;
+    store(base, h, sizeof(h));
+}
+
+static void append(uint16_t addr, uint16_t gen, uint8_t key, const uint8_t *value, uint8_t len) {
+    uint16_t crc = record_crc(gen, key, value, len);
+    uint8_t head[2] = { key, len };
+    uint8_t tail[2] = { crc & 0xFF, crc >> 8 };
+    store(addr, head, sizeof(head));
+    store(addr + 2, value, len);
+    store(addr + 2 + len, tail, sizeof(tail));
+}
+
+// Read the record at 'addr' into 'value' if it is valid in the active bank
+static bool read_record(uint16_t addr, uint8_t *key, uint8_t *value, uint8_t *len) {
+    uint16_t limit = bank + BANK_SIZE;
+    if (addr + RECORD_OVERHEAD > limit)
+        return false;
+    *key = eeprom_read_byte(addr);
+    *len = eeprom_read_byte(addr + 1);
+    if (*key >= KV_MAX_KEYS || *len > KV_VALUE_MAX || addr + RECORD_OVERHEAD + *len > limit)
+        return false;
+    eeprom_read(addr + 2, value, *len);
+    uint16_t crc = eeprom_read_byte(addr + 2 + *len) | (uint16_t)eeprom_read_byte(addr + 3 + *len) << 8;
+    return crc == record_crc(generation, *key, value, *len);
+}
+
+// Replay the log of the active bank into the index
+static void scan(void) {
+    uint8_t value[KV_VALUE_MAX];
+    uint8_t key, len;
+
+    memset(latest, 0, sizeof(latest));
+    end = bank + HEADER_SIZE;
+    while (read_record(end, &key, value, &len)) {
+        latest[key] = len ? end : 0;
+        end += RECORD_OVERHEAD + len;
+    }
+}
+
+static uint8_t value_len(uint8_t key) {
+    return latest[key] ? eeprom_read_byte(latest[key] + 1) : 0;
+}
+
+// Bytes the newest records take, without 'skip' (KV_MAX_KEYS for none)
+static uint16_t live_bytes(uint8_t skip) {
+    uint16_t live = 0;
+    for (uint8_t key = 0; key < KV_MAX_KEYS; key++) {
+        if (key != skip && latest[key])
+            live += RECORD_OVERHEAD + value_len(key);
+    }
+    return live;
+}
+
+// Switch to the other bank with the newest record of every key and, in
+// place of the one of 'key', the new value (len 0: none). Either the old
+// or the new bank is valid at any time, so a power loss keeps the key's
+// old or new value, never neither.
+static void compact(uint8_t key, const uint8_t *value, uint8_t len) {
+    uint16_t target = (bank == KV_EEPROM_START) ? KV_EEPROM_START + BANK_SIZE : KV_EEPROM_START;
+    uint16_t gen = generation + 1;
+    uint16_t addr = target + HEADER_SIZE;
+    uint8_t copy[KV_VALUE_MAX];
+
+    for (uint8_t k = 0; k < KV_MAX_KEYS; k++) {
+        if (k == key || !latest[k])
+            continue;
+        uint8_t n = value_len(k);
+        eeprom_read(latest[k] + 2, copy, n);
+        append(addr, gen, k, copy, n);
+        latest[k] = addr;
+        addr += RECORD_OVERHEAD + n;
+    }
+    latest[key] = 0;
+    if (len) {
+        append(addr, gen, key, value, len);
+        latest[key] = addr;
+        addr += RECORD_OVERHEAD + len;
+    }
+
+    // the header only once the records are in: until it is valid, the old
+    // bank wins after a power loss
+    while (eeprom_busy())
+        watchdog_wait();
+    write_header(target, gen);
+
+    bank = target;
+    generation = gen;
+    end = addr;
+}
+
+void kv_init(void) {
+    uint16_t gen0, gen1;
+    bool valid0 = header_valid(KV_EEPROM_START, &gen0);
+    bool valid1 = header_valid(KV_EEPROM_START + BANK_SIZE, &gen1);
+
+    if (valid1 && (!valid0 || (int16_t)(gen1 - gen0) > 0)) {
+        bank = KV_EEPROM_START + BANK_SIZE;
+        generation = gen1;
+    } else if (valid0) {
+        bank = KV_EEPROM_START;
+        generation = gen0;
+    } else {
+        bank = KV_EEPROM_START;
+        generation = 1;
+        write_header(bank, generation);
+    }
+    scan();
+}
+
+int16_t kv_get(uint8_t key, void *value, uint8_t size) {
+    if (key >= KV_MAX_KEYS || !latest[key])
+        return -1;
+    uint8_t len = value_len(key);
+    eeprom_read(latest[key] + 2, value, (len < size) ? len : size);
+    return len;
+}
+
+bool kv_set(uint8_t key, const void *value, uint8_t len) {
+    if (key >= KV_MAX_KEYS || len > KV_VALUE_MAX)
+        return false;
+
+    // nothing to do for the value the key already has
+    if (len == value_len(key)) {
+        uint8_t old[KV_VALUE_MAX];
+        eeprom_read(latest[key] + 2, old, len);
+        if (len == 0 || memcmp(old, value, len) == 0)
+            return true;
+    }
+
+    uint16_t need = RECORD_OVERHEAD + len;
+    if (end + need > bank + BANK_SIZE) {
+        if (live_bytes(key) + (len ? need : 0) > BANK_SIZE - HEADER_SIZE)
+            return false;
+        compact(key, value, len);
+        return true;
+    }
+
+    append(end, generation, key, value, len);
+    latest[key] = len ? end : 0;
+    end += need;
+    return true;
+}
+
+void kv_info(kv_info_t *info) {
+    info->generation = generation;
+    info->capacity = BANK_SIZE - HEADER_SIZE;
+    info->used = end - bank - HEADER_SIZE;
+    info->live = live_bytes(KV_MAX_KEYS);
+}
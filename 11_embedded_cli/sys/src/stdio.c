@@ -139,17 +139,13 @@ void stdio_print_scientific(output_putc_t putc, double val, int precision, char
 }
 
 // --- Main printf function ---
-// Uses output_putc function pointer to redirect output
-void printf(const char *fmt, ...) {
-    va_list args;
-    va_start(args, fmt);
-
-    output_putc_t putc = output_get_putc();
-    if (!putc) return; // No output function set
+// Shared by printf and printf_P; 'progmem' selects where fmt is read from.
+// Arguments for %s are always RAM strings.
+#define FMT_NEXT() (progmem ? (char)pgm_read_byte(fmt++) : *fmt++)
 
+static void print_formatted(output_putc_t putc, const char *fmt, bool progmem, va_list args) {
     char c;
-    // For sprintf, format string is in RAM (not PROGMEM)
-    while ((c = *fmt++)) {
+    while ((c = FMT_NEXT())) {
         if (c == '%') {
             bool plus = false;
             bool alt = false;
@@ -158,29 +154,29 @@ void printf(const char *fmt, ...) {
             bool long_flag = false;
             int precision = 6; // default float precision
 
-            c = *fmt++;
+            c = FMT_NEXT();
             while (c == '+' || c == '0' || c == '#') {
                 if (c == '+') plus = true;
                 if (c == '0') pad = '0';
                 if (c == '#') alt = true;
-                c = *fmt++;
+                c = FMT_NEXT();
             }
 
             while (c >= '0' && c <= '9') {
                 width = width * 10 + (c - '0');
-                c = *fmt++;
+                c = FMT_NEXT();
             }
 
             if (c == '.') {
-                c = *fmt++;
+                c = FMT_NEXT();
                 precision = 0;
                 while (c >= '0' && c <= '9') {
                     precision = precision * 10 + (c - '0');
-                    c = *fmt++;
+                    c = FMT_NEXT();
                 }
             }
 
-            if (c == 'l') { long_flag = true; c = *fmt++; }
+            if (c == 'l') { long_flag = true; c = FMT_NEXT(); }
 
             switch (c) {
                 case 'c': putc((char)va_arg(args, int)); break;
@@ -241,7 +237,27 @@ void printf(const char *fmt, ...) {
             else putc(c);
         }
     }
+}
+
+// Uses output_putc function pointer to redirect output
+void printf(const char *fmt, ...) {
+    output_putc_t putc = output_get_putc();
+    if (!putc) return; // No output function set
+
+    va_list args;
+    va_start(args, fmt);
+    print_formatted(putc, fmt, false, args);
+    va_end(args);
+}
+
+// Same as printf with the format string in flash: printf_P(PSTR("..."))
+void printf_P(const char *fmt, ...) {
+    output_putc_t putc = output_get_putc();
+    if (!putc) return; // No output function set
 
+    va_list args;
+    va_start(args, fmt);
+    print_formatted(putc, fmt, true, args);
     va_end(args);
 }
 
@@ -408,7 +424,6 @@ int sprintf(char *str, const char *fmt, ...) {
     ctx.max_size = 32767; // Maximum reasonable size for embedded systems
 
     char c;
-    // For sprintf, format string is in RAM (not PROGMEM)
     while ((c = *fmt++)) {
         if (c == '%') {
             bool plus = false;
@@ -418,29 +433,29 @@ int sprintf(char *str, const char *fmt, ...) {
             bool long_flag = false;
             int precision = 6; // default float precision
 
-            c = pgm_read_byte(fmt++);
+            c = *fmt++;
             while (c == '+' || c == '0' || c == '#') {
                 if (c == '+') plus = true;
                 if (c == '0') pad = '0';
                 if (c == '#') alt = true;
-                c = pgm_read_byte(fmt++);
+                c = *fmt++;
             }
 
             while (c >= '0' && c <= '9') {
                 width = width * 10 + (c - '0');
-                c = pgm_read_byte(fmt++);
+                c = *fmt++;
             }
 
             if (c == '.') {
-                c = pgm_read_byte(fmt++);
+                c = *fmt++;
                 precision = 0;
                 while (c >= '0' && c <= '9') {
                     precision = precision * 10 + (c - '0');
-                    c = pgm_read_byte(fmt++);
+                    c = *fmt++;
                 }
             }
 
-            if (c == 'l') { long_flag = true; c = pgm_read_byte(fmt++); }
+            if (c == 'l') { long_flag = true; c = *fmt++; }
 
             switch (c) {
                 case 'c': buffer_putc((char)va_arg(args, int), &ctx); break;
@@ -0,0 +1,53 @@
+#include "tick.h"
+#include "events.h"
+#include "config.h"
+
+#define TICK_PRESCALER  64
+#define TICK_HZ         1000
+#define TICK_OCR        ((F_CPU / TICK_PRESCALER / TICK_HZ) - 1)
+
+#define TICK_US_PER_COUNT (TICK_PRESCALER / (F_CPU / 1000000UL))
+
+#if TICK_OCR > 255
+#error "Timer0 tick period does not fit in 8 bits, increase TICK_PRESCALER"
+#endif
+#if TICK_US_PER_COUNT * (F_CPU / 1000000UL) != TICK_PRESCALER
+#error "tick_micros() needs a whole number of microseconds per Timer0 count"
+#endif
+
+static volatile uint32_t tick_ms;
+
+ISR(TIMER0_COMPA_vect) {
+    tick_ms++;
+    event_set(EVENT_TICK);
+}
+
+void tick_init(void) {
+    TCCR0A = (1 << WGM01);                  // CTC, TOP = OCR0A
+    TCCR0B = (1 << CS01) | (1 << CS00);     // clk/64
+    OCR0A = TICK_OCR;
+    TCNT0 = 0;
+    TIFR0 = (1 << OCF0A);
+    TIMSK0 = (1 << OCIE0A);
+}
+
+uint32_t tick_millis(void) {
+    uint8_t sreg = SREG;
+    cli();
+    uint32_t ms = tick_ms;
+    SREG = sreg;
+    return ms;
+}
+
+uint32_t tick_micros(void) {
+    uint8_t sreg = SREG;
+    cli();
+    uint32_t ms = tick_ms;
+    uint8_t count = TCNT0;
+    // the counter has wrapped but the interrupt has not run yet (we are
+    // in another handler, or it is the very next instruction)
+    if ((TIFR0 & (1 << OCF0A)) && count < TICK_OCR / 2)
+        ms++;
+    SREG = sreg;
+    return ms * 1000 + (uint16_t)count * TICK_US_PER_COUNT;
+}
@@ -0,0 +1,93 @@
+#include "watchdog.h"
+#include "crash.h"
+#include "tick.h"
+#include "avr/io.h"
+#include "avr/interrupt.h"
+#include "avr/wdt.h"
+#include "stddef.h"
+#include "stdbool.h"
+
+typedef struct {
+    const char *name;
+    uint16_t deadline;              // ms
+    volatile uint16_t last;         // tick_millis() of the last check-in
+} watchdog_task_t;
+
+static watchdog_task_t tasks[WATCHDOG_MAX_TASKS];
+static uint8_t task_count;
+static bool overrun_traced;
+
+uint8_t watchdog_register(const char *name, uint16_t deadline_ms) {
+    if (task_count == WATCHDOG_MAX_TASKS)
+        return WATCHDOG_NO_TASK;
+
+    watchdog_task_t *t = &tasks[task_count];
+    t->name = name;
+    t->deadline = deadline_ms;
+    t->last = (uint16_t)tick_millis();
+    return task_count++;
+}
+
+void watchdog_checkin(uint8_t task) {
+    if (task >= task_count)
+        return;
+    uint16_t now = (uint16_t)tick_millis();
+    uint8_t sreg = SREG;
+    cli();
+    tasks[task].last = now;
+    SREG = sreg;
+}
+
+static void checkin_all(void) {
+    uint16_t now = (uint16_t)tick_millis();
+    uint8_t sreg = SREG;
+    cli();
+    for (uint8_t i = 0; i < task_count; i++)
+        tasks[i].last = now;
+    SREG = sreg;
+}
+
+void watchdog_start(uint8_t timeout) {
+    checkin_all();
+    overrun_traced = false;
+    wdt_enable_irq(timeout);
+}
+
+void watchdog_wait(void) {
+    checkin_all();
+    watchdog_service();
+}
+
+uint8_t watchdog_overdue(void) {
+    uint16_t now = (uint16_t)tick_millis();
+
+    for (uint8_t i = 0; i < task_count; i++) {
+        uint8_t sreg = SREG;
+        cli();
+        uint16_t last = tasks[i].last;
+        SREG = sreg;
+        // 16-bit wrap-around is fine for deadlines below 32768 ms
+        if ((uint16_t)(now - last) > tasks[i].deadline)
+            return i;
+    }
+    return WATCHDOG_NO_TASK;
+}
+
+void watchdog_service(void) {
+    uint8_t task = watchdog_overdue();
+    if (task == WATCHDOG_NO_TASK) {
+        wdt_reset();
+        overrun_traced = false;
+        return;
+    }
+
+    // stop kicking: the WDT interrupt records the fault, then it resets
+    if (!overrun_traced) {
+        crash_trace(CRASH_TRACE_OVERRUN, task);
+        overrun_traced = true;
+    }
+}
+
+const char *watchdog_task_name(uint8_t task) {
+    return (task < task_count) ? tasks[task].name : NULL;
+}
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""
+check_gpio.py
+
+Proves from the build listing (objdump -d -S output, build/<project>.lst)
+that the gpio.h pin operations compile to what they promise:
+
+  gpio_set / gpio_clear / gpio_toggle / gpio_output / gpio_input /
+  gpio_pullup                       -> exactly one sbi or cbi, no in/out
+  gpio_write_mask                   -> at most 4 instructions, one out
+
+For every source line in the listing that calls one of these, the
+instructions listed under it (up to the next source line) are counted.
+
+Usage:
+    python3 tools/check_gpio.py build/11_embedded_cli.lst
+
+Exits non-zero if any operation does not match.
+"""
+
+import re
+import sys
+
+SINGLE = re.compile(r"\bgpio_(set|clear|toggle|output|input|pullup)\s*\(")
+MASK = re.compile(r"\bgpio_write_mask\s*\(")
+INSN = re.compile(r"^\s*[0-9a-f]+:\s+(?:[0-9a-f]{2} )+\s*(\w+)")
+LABEL = re.compile(r"^[0-9a-f]+ <.*>:$")
+
+
+def blocks(lines):
+    """Yield (source line, [mnemonics]) for each source line in the listing."""
+    source = None
+    insns = []
+    for line in lines:
+        line = line.rstrip("\n")
+        m = INSN.match(line)
+        if m:
+            if source is not None:
+                insns.append(m.group(1))
+            continue
+        if not line.strip() or LABEL.match(line):
+            continue
+        if source is not None:
+            yield source, insns
+        source = line
+        insns = []
+    if source is not None:
+        yield source, insns
+
+
+def main():
+    if len(sys.argv) != 2:
+        print(__doc__)
+        return 2
+
+    with open(sys.argv[1]) as f:
+        lines = f.readlines()
+
+    checked = 0
+    errors = 0
+    for source, insns in blocks(lines):
+        text = source.strip()
+        if text.startswith("#define") or text.startswith("//"):
+            continue
+        if SINGLE.search(text):
+            # the compiler may schedule unrelated code (e.g. a ret) under
+            # the same line; the operation itself must be one sbi/cbi and
+            # nothing that reads or writes the whole port
+            bit_ops = [i for i in insns if i in ("sbi", "cbi")]
+            ok = (len(bit_ops) == 1 and insns[0] in ("sbi", "cbi")
+                  and not any(i in ("in", "out", "lds", "sts") for i in insns))
+        elif MASK.search(text):
+            ok = 0 < len(insns) <= 4 and insns.count("out") == 1
+        else:
+            continue
+        # the same source line can appear several times (inlining)
+        if not insns:
+            continue
+        checked += 1
+        status = "ok  " if ok else "FAIL"
+        print("%s %-50s %s" % (status, text[:50], " ".join(insns)))
+        if not ok:
+            errors += 1
+
+    print("%d gpio operations checked, %d errors" % (checked, errors))
+    return 1 if errors or not checked else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""
+check_vectors.py
+
+Checks the interrupt vector table of a linked ELF against the device
+description in lib/avr/io.h (the *_vect_num defines):
+
+  - every slot is a 4-byte JMP at address 4 * n
+  - slot 0 jumps to reset
+  - slot n jumps to __vector_n (a handler or the weak __bad_interrupt alias)
+
+and prints which vectors have a handler installed.
+
+Usage:
+    python3 tools/check_vectors.py build/11_embedded_cli.elf \
+        --objdump avr-objdump --nm avr-nm
+
+Exits non-zero if any slot is wrong.
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+IO_H = os.path.join(os.path.dirname(__file__), "..", "lib", "avr", "io.h")
+
+
+def read_vectors(path):
+    names = {0: "RESET"}
+    size = None
+    with open(path) as f:
+        for line in f:
+            m = re.match(r"#define\s+(\w+)_vect_num\s+(\d+)", line)
+            if m:
+                names[int(m.group(2))] = m.group(1)
+            m = re.match(r"#define\s+_VECTORS_SIZE\s+\((\d+)\s*\*\s*4\)", line)
+            if m:
+                size = int(m.group(1))
+    return names, size
+
+
+def read_symbols(nm, elf):
+    out = subprocess.run([nm, elf], capture_output=True, text=True, check=True).stdout
+    symbols = {}
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 3:
+            symbols[parts[2]] = (int(parts[0], 16), parts[1])
+    return symbols
+
+
+def read_slots(objdump, elf):
+    out = subprocess.run([objdump, "-d", "-j", ".vectors", elf],
+                         capture_output=True, text=True, check=True).stdout
+    slots = {}
+    for line in out.splitlines():
+        m = re.match(r"\s*([0-9a-f]+):\s+(?:[0-9a-f]{2} )+\s*(\w+)\s+(0x[0-9a-f]+|\.[+-]\d+)", line)
+        if m:
+            slots[int(m.group(1), 16)] = (m.group(2), m.group(3))
+    return slots
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Check the AVR interrupt vector table")
+    parser.add_argument("elf")
+    parser.add_argument("--objdump", default="avr-objdump")
+    parser.add_argument("--nm", default="avr-nm")
+    args = parser.parse_args()
+
+    names, count = read_vectors(IO_H)
+    symbols = read_symbols(args.nm, args.elf)
+    slots = read_slots(args.objdump, args.elf)
+    bad = symbols.get("__bad_interrupt", (None, None))[0]
+    errors = 0
+
+    for n in range(count):
+        name = names.get(n, "?")
+        slot = slots.get(4 * n)
+        if slot is None or slot[0] != "jmp":
+            print("%2d %-14s slot at 0x%02x is not a jmp: %s" % (n, name, 4 * n, slot))
+            errors += 1
+            continue
+
+        target = int(slot[1], 16)
+        expected = "reset" if n == 0 else "__vector_%d" % n
+        if expected not in symbols:
+            print("%2d %-14s %s is missing" % (n, name, expected))
+            errors += 1
+            continue
+
+        address, kind = symbols[expected]
+        if target != address:
+            print("%2d %-14s jumps to 0x%04x, %s is at 0x%04x" % (n, name, target, expected, address))
+            errors += 1
+        elif n == 0:
+            print("%2d %-14s -> reset" % (n, name))
+        elif kind in "Ww" or address == bad:
+            print("%2d %-14s -> __bad_interrupt" % (n, name))
+        else:
+            print("%2d %-14s -> handler at 0x%04x" % (n, name, address))
+
+    print("%d vectors checked, %d errors" % (count, errors))
+    return 1 if errors else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
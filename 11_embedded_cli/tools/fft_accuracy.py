@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+"""
+fft_accuracy.py
+
+Measures the accuracy of the fixed-point FFT in lib/dsp against a
+double-precision DFT. lib/dsp/src/fft.c is compiled for the host (the
+multiply kernels in fixmath.h have portable C fallbacks; flash reads are
+mapped to plain reads), loaded with ctypes and fed test signals at each
+size; the output, scaled back by its block exponent, is compared with the
+reference.
+
+Per size and signal it prints the signal-to-error ratio over all bins,
+the largest bin error relative to the largest reference bin, and the
+largest error of the magnitude approximation.
+
+Usage:
+    python3 tools/fft_accuracy.py
+    python3 tools/fft_accuracy.py --cc clang --min-snr 60
+
+Exits non-zero if a case falls below --min-snr (dB).
+"""
+
+import argparse
+import cmath
+import ctypes
+import math
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+PGMSPACE_SHIM = """\
+#include <stdint.h>
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+"""
+
+
+def build(cc, workdir):
+    with open(os.path.join(workdir, "pgmspace.h"), "w") as f:
+        f.write(PGMSPACE_SHIM)
+    lib = os.path.join(workdir, "fft.so")
+    subprocess.check_call([
+        cc, "-O2", "-shared", "-fPIC", "-I" + workdir,
+        "-I" + os.path.join(ROOT, "lib", "dsp"),
+        "-I" + os.path.join(ROOT, "lib", "fixmath"),
+        os.path.join(ROOT, "lib", "dsp", "src", "fft.c"), "-o", lib,
+    ])
+    dll = ctypes.CDLL(lib)
+    for name in ("dsp_fft", "dsp_fft_real"):
+        fn = getattr(dll, name)
+        fn.restype = ctypes.c_int8
+        fn.argtypes = [ctypes.POINTER(ctypes.c_int16), ctypes.c_uint8]
+    dll.dsp_fft_magnitude.restype = None
+    dll.dsp_fft_magnitude.argtypes = [ctypes.POINTER(ctypes.c_int16),
+                                      ctypes.POINTER(ctypes.c_uint16), ctypes.c_uint16]
+    return dll
+
+
+def dft(x):
+    n = len(x)
+    w = [cmath.exp(-2j * math.pi * k / n) for k in range(n)]
+    return [sum(v * w[(k * i) % n] for i, v in enumerate(x)) for k in range(n)]
+
+
+def q15(v):
+    return max(-32768, min(32767, int(round(v * 32768))))
+
+
+def signals(n, rng):
+    yield "tone", [0.5 * math.cos(2 * math.pi * 5 * i / n) for i in range(n)]
+    yield "two tones", [0.6 * math.sin(2 * math.pi * 7.3 * i / n)
+                        + 0.3 * math.sin(2 * math.pi * 0.41 * i) for i in range(n)]
+    yield "noise", [rng.uniform(-0.99, 0.99) for _ in range(n)]
+    yield "full scale", [0.99997 if (i // 4) % 2 else -1.0 for i in range(n)]
+    yield "small", [0.002 * math.cos(2 * math.pi * 3 * i / n) for i in range(n)]
+
+
+def compare(ref, got):
+    signal = sum(abs(r) ** 2 for r in ref)
+    error = sum(abs(g - r) ** 2 for g, r in zip(got, ref))
+    peak = max(abs(r) for r in ref)
+    worst = max(abs(g - r) for g, r in zip(got, ref))
+    snr = 10 * math.log10(signal / error) if error else float("inf")
+    return snr, worst / peak
+
+
+def magnitude_error(dll, data, bins):
+    arr = (ctypes.c_int16 * (2 * bins))(*data[:2 * bins])
+    mag = (ctypes.c_uint16 * bins)()
+    dll.dsp_fft_magnitude(arr, mag, bins)
+    peak = max(math.hypot(data[2 * k], data[2 * k + 1]) for k in range(bins))
+    worst = 0.0
+    for k in range(bins):
+        true = math.hypot(data[2 * k], data[2 * k + 1])
+        if true > peak / 100:
+            worst = max(worst, abs(mag[k] - true) / true)
+    return worst
+
+
+def run_complex(dll, n, samples):
+    # imaginary part: the signal reversed and scaled, unlike the real part
+    im = [v * 0.7 for v in samples[::-1]]
+    x = [complex(q15(r), q15(i)) / 32768 for r, i in zip(samples, im)]
+    data = []
+    for v in x:
+        data += [q15(v.real), q15(v.imag)]
+    arr = (ctypes.c_int16 * len(data))(*data)
+    e = dll.dsp_fft(arr, n.bit_length() - 1)
+    got = [complex(arr[2 * k], arr[2 * k + 1]) * 2 ** e / 32768 for k in range(n)]
+    snr, worst = compare(dft(x), got)
+    return snr, worst, e, magnitude_error(dll, list(arr), n)
+
+
+def run_real(dll, n, samples):
+    data = [q15(v) for v in samples]
+    x = [v / 32768 for v in data]
+    arr = (ctypes.c_int16 * n)(*data)
+    e = dll.dsp_fft_real(arr, n.bit_length() - 1)
+    scale = 2 ** e / 32768
+    got = [complex(arr[0] * scale, 0)]
+    got += [complex(arr[2 * k], arr[2 * k + 1]) * scale for k in range(1, n // 2)]
+    got += [complex(arr[1] * scale, 0)]
+    ref = dft(x)[:n // 2 + 1]
+    snr, worst = compare(ref, got)
+    return snr, worst, e, magnitude_error(dll, [0, 0] + list(arr)[2:], n // 2)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Fixed-point FFT accuracy against a double DFT")
+    parser.add_argument("--cc", default=os.environ.get("CC", "cc"), help="host C compiler")
+    parser.add_argument("--min-snr", type=float, default=45.0, help="fail below this SNR (dB)")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as workdir:
+        dll = build(args.cc, workdir)
+        rng = random.Random(1)
+        failed = False
+
+        print("%-8s %-5s %-11s %8s %10s %4s %8s" % ("type", "N", "signal", "SNR dB", "max err", "exp", "mag err"))
+        for n in (64, 128, 256):
+            for name, samples in signals(n, rng):
+                for kind in ("complex", "real"):
+                    if kind == "complex":
+                        snr, worst, e, mag = run_complex(dll, n, samples)
+                    else:
+                        snr, worst, e, mag = run_real(dll, n, samples)
+                    flag = ""
+                    if snr < args.min_snr:
+                        flag = "  < %.0f dB" % args.min_snr
+                        failed = True
+                    print("%-8s %-5d %-11s %8.1f %9.2e %4d %7.1f%%%s"
+                          % (kind, n, name, snr, worst, e, mag * 100, flag))
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
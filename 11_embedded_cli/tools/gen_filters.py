@@ -0,0 +1,237 @@
+#!/usr/bin/env python3
+"""
+gen_filters.py
+
+Designs the fixed-point filters listed in a JSON spec and writes their
+coefficients as a C header of PROGMEM tables for lib/dsp (dsp.h), so
+filters are changed by editing the spec instead of pasting numbers.
+The build runs it before compiling; it needs nothing beyond the standard
+library.
+
+Frequencies are fractions of the sample rate (0 .. 0.5).
+
+  "fir": windowed-sinc FIR, Q1.15 taps
+      {"name": "lp_fir", "type": "lowpass", "taps": 31, "cutoff": 0.1,
+       "window": "hamming"}
+      type lowpass / highpass (odd taps) use "cutoff", bandpass uses
+      "low" and "high"; window rect, hann, hamming or blackman.
+
+  "biquad": cascade of second-order sections, Q2.14 coefficients
+      {"name": "lp_iir", "type": "lowpass", "order": 4, "f0": 0.05}
+      type lowpass / highpass with an even "order" are Butterworth;
+      type lowpass, highpass, bandpass or notch with "q" is a single
+      section (RBJ audio EQ cookbook).
+
+Usage:
+    python3 tools/gen_filters.py src/filters.json build/gen/filter_coeffs.h
+
+Exits non-zero if a filter cannot be represented (taps or coefficients
+out of range, or a section made unstable by quantisation).
+"""
+
+import argparse
+import json
+import math
+import sys
+
+FIR_SCALE = 1 << 15
+BIQUAD_SCALE = 1 << 14
+
+
+class SpecError(Exception):
+    pass
+
+
+# --- FIR ---
+
+def window(kind, n):
+    if n == 1:
+        return [1.0]
+    m = n - 1
+    if kind == "rect":
+        return [1.0] * n
+    if kind == "hann":
+        return [0.5 - 0.5 * math.cos(2 * math.pi * i / m) for i in range(n)]
+    if kind == "hamming":
+        return [0.54 - 0.46 * math.cos(2 * math.pi * i / m) for i in range(n)]
+    if kind == "blackman":
+        return [0.42 - 0.5 * math.cos(2 * math.pi * i / m) + 0.08 * math.cos(4 * math.pi * i / m)
+                for i in range(n)]
+    raise SpecError("unknown window '%s'" % kind)
+
+
+def sinc_lowpass(n, fc, w):
+    centre = (n - 1) / 2.0
+    h = []
+    for i in range(n):
+        t = i - centre
+        v = 2 * fc if t == 0 else math.sin(2 * math.pi * fc * t) / (math.pi * t)
+        h.append(v * w[i])
+    return h
+
+
+def gain_at(h, f):
+    re = sum(v * math.cos(2 * math.pi * f * i) for i, v in enumerate(h))
+    im = sum(v * math.sin(2 * math.pi * f * i) for i, v in enumerate(h))
+    return math.hypot(re, im)
+
+
+def design_fir(spec):
+    n = spec["taps"]
+    kind = spec.get("type", "lowpass")
+    w = window(spec.get("window", "hamming"), n)
+    if not 1 <= n <= 255:
+        raise SpecError("taps must be 1..255")
+
+    if kind == "lowpass":
+        h = sinc_lowpass(n, spec["cutoff"], w)
+        g = sum(h)
+    elif kind == "highpass":
+        if n % 2 == 0:
+            raise SpecError("a highpass FIR needs an odd number of taps")
+        h = [-v for v in sinc_lowpass(n, spec["cutoff"], w)]
+        h[(n - 1) // 2] += 1.0
+        g = gain_at(h, 0.5)
+    elif kind == "bandpass":
+        lo = sinc_lowpass(n, spec["low"], w)
+        hi = sinc_lowpass(n, spec["high"], w)
+        h = [b - a for a, b in zip(lo, hi)]
+        g = gain_at(h, (spec["low"] + spec["high"]) / 2)
+    else:
+        raise SpecError("unknown FIR type '%s'" % kind)
+
+    h = [v / g for v in h]          # unity gain in the pass band
+    q = [int(round(v * FIR_SCALE)) for v in h]
+    if any(v >= FIR_SCALE or v < -FIR_SCALE for v in q):
+        raise SpecError("a tap does not fit in Q1.15")
+    if sum(abs(v) for v in q) >= 2 * FIR_SCALE:
+        raise SpecError("sum of |taps| must stay below 2")
+    return q
+
+
+# --- Biquad ---
+
+def rbj(kind, f0, q):
+    w0 = 2 * math.pi * f0
+    c = math.cos(w0)
+    alpha = math.sin(w0) / (2 * q)
+    if kind == "lowpass":
+        b = [(1 - c) / 2, 1 - c, (1 - c) / 2]
+    elif kind == "highpass":
+        b = [(1 + c) / 2, -(1 + c), (1 + c) / 2]
+    elif kind == "bandpass":
+        b = [alpha, 0.0, -alpha]
+    elif kind == "notch":
+        b = [1.0, -2 * c, 1.0]
+    else:
+        raise SpecError("unknown biquad type '%s'" % kind)
+    a0 = 1 + alpha
+    return [v / a0 for v in b], [-2 * c / a0, (1 - alpha) / a0]
+
+
+def quantise_section(b, a):
+    # a1 and a2 are stored negated (dsp.h)
+    values = b + [-a[0], -a[1]]
+    q = [int(round(v * BIQUAD_SCALE)) for v in values]
+    if any(v >= 2 * BIQUAD_SCALE or v < -2 * BIQUAD_SCALE for v in q):
+        raise SpecError("a coefficient does not fit in Q2.14")
+    a1 = -q[3] / BIQUAD_SCALE
+    a2 = -q[4] / BIQUAD_SCALE
+    if not (abs(a2) < 1 and abs(a1) < 1 + a2):
+        raise SpecError("section is unstable once quantised (f0 too low for Q2.14?)")
+    return q
+
+
+def design_biquad(spec):
+    kind = spec.get("type", "lowpass")
+    f0 = spec["f0"]
+    if not 0 < f0 < 0.5:
+        raise SpecError("f0 must be between 0 and 0.5")
+    if "order" in spec:
+        order = spec["order"]
+        if kind not in ("lowpass", "highpass") or order < 2 or order % 2:
+            raise SpecError("Butterworth needs type lowpass/highpass and an even order")
+        qs = [1 / (2 * math.cos(math.pi * (2 * k + 1) / (2 * order))) for k in range(order // 2)]
+    else:
+        qs = [spec.get("q", 1 / math.sqrt(2))]
+    return [quantise_section(*rbj(kind, f0, q)) for q in qs]
+
+
+# --- Output ---
+
+def describe(spec):
+    return ", ".join("%s %s" % (k, v) for k, v in spec.items() if k != "name")
+
+
+def rows(values, per_row=8):
+    out = []
+    for i in range(0, len(values), per_row):
+        out.append("    " + ", ".join("%6d" % v for v in values[i:i + per_row]))
+    return ",\n".join(out)
+
+
+def generate(spec, source):
+    lines = [
+        "// Generated by tools/gen_filters.py from %s; do not edit." % source,
+        "#ifndef FILTER_COEFFS_H",
+        "#define FILTER_COEFFS_H",
+        "",
+        '#include "dsp.h"',
+        '#include "pgmspace.h"',
+    ]
+
+    for f in spec.get("fir", []):
+        name = f["name"]
+        try:
+            taps = design_fir(f)
+        except (SpecError, KeyError) as e:
+            raise SpecError("%s: %s" % (name, e))
+        lines += [
+            "",
+            "// %s" % describe(f),
+            "#define %s_TAPS %d" % (name.upper(), len(taps)),
+            "static const q15_t %s[%d] PROGMEM = {" % (name, len(taps)),
+            rows(taps),
+            "};",
+        ]
+
+    for f in spec.get("biquad", []):
+        name = f["name"]
+        try:
+            sections = design_biquad(f)
+        except (SpecError, KeyError) as e:
+            raise SpecError("%s: %s" % (name, e))
+        lines += [
+            "",
+            "// %s" % describe(f),
+            "#define %s_SECTIONS %d" % (name.upper(), len(sections)),
+            "static const dsp_biquad_coeffs_t %s[%d] PROGMEM = {" % (name, len(sections)),
+            ",\n".join("    { %s }" % ", ".join("%6d" % v for v in s) for s in sections),
+            "};",
+        ]
+
+    lines += ["", "#endif // FILTER_COEFFS_H", ""]
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate fixed-point filter coefficient tables")
+    parser.add_argument("spec", help="JSON filter spec")
+    parser.add_argument("output", help="C header to write")
+    args = parser.parse_args()
+
+    with open(args.spec) as f:
+        spec = json.load(f)
+    try:
+        text = generate(spec, args.spec.replace("\\", "/"))
+    except SpecError as e:
+        print("gen_filters: %s" % e, file=sys.stderr)
+        return 1
+
+    with open(args.output, "w", newline="\n") as f:
+        f.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
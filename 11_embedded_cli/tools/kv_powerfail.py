@@ -0,0 +1,251 @@
+#!/usr/bin/env python3
+"""
+kv_powerfail.py
+
+Checks that the key/value store (sys/src/kv.c) survives power loss at
+any point of a write. kv.c is compiled for the host against a simulated
+EEPROM that programs bytes in queue order, as the EE_READY interrupt
+does, and can cut the power after a given number of bytes: the byte
+being programmed is left with a random value and later writes are lost.
+The library is loaded with ctypes.
+
+Each step sets a random key (short values, deletes, and now and then the
+largest value). The step is run once to count the bytes it programs,
+then, from the same EEPROM contents, again with the power cut at a
+random one of those bytes. After kv_init(), as on the next boot, the key
+must hold its old or its new value and every other key must be
+unchanged. Steps that fill a bank exercise interrupted compactions.
+
+Usage:
+    python3 tools/kv_powerfail.py
+    python3 tools/kv_powerfail.py --steps 20000 --seed 7 --cc clang
+
+Exits non-zero on the first step that loses or corrupts a value.
+"""
+
+import argparse
+import ctypes
+import os
+import random
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+EEPROM_SIZE = 1024
+KV_MAX_KEYS = 32
+KV_VALUE_MAX = 32
+
+EEPROM_SHIM = """\
+#include <stdint.h>
+#include <stdbool.h>
+#define EEPROM_SIZE %d
+#define EEPROM_QUEUE_SIZE 32
+void eeprom_read(uint16_t addr, void *data, uint16_t len);
+uint8_t eeprom_read_byte(uint16_t addr);
+void eeprom_write(uint16_t addr, const void *data, uint16_t len);
+uint8_t eeprom_free(void);
+bool eeprom_busy(void);
+""" % EEPROM_SIZE
+
+WATCHDOG_SHIM = """\
+static inline void watchdog_wait(void) {}
+"""
+
+# Writes are programmed at once, in order; reads see the cells. Bytes
+# equal to the cell are skipped without a program cycle, as in the ISR.
+EEPROM_SIM = """\
+#include "eeprom.h"
+#include <stdlib.h>
+
+uint8_t sim_eeprom[EEPROM_SIZE];
+uint32_t sim_programmed;        // bytes programmed since sim_power()
+int32_t sim_budget;             // bytes until the power cut, -1 for none
+bool sim_dead;
+
+void sim_power(int32_t budget, unsigned seed) {
+    sim_programmed = 0;
+    sim_budget = budget;
+    sim_dead = false;
+    srand(seed);
+}
+
+void eeprom_read(uint16_t addr, void *data, uint16_t len) {
+    uint8_t *p = data;
+    while (len--)
+        *p++ = sim_eeprom[addr++ % EEPROM_SIZE];
+}
+
+uint8_t eeprom_read_byte(uint16_t addr) {
+    return sim_eeprom[addr % EEPROM_SIZE];
+}
+
+void eeprom_write(uint16_t addr, const void *data, uint16_t len) {
+    const uint8_t *p = data;
+    for (; len--; addr++, p++) {
+        uint8_t *cell = &sim_eeprom[addr % EEPROM_SIZE];
+        if (sim_dead || *cell == *p)
+            continue;
+        if (sim_budget >= 0 && sim_programmed == (uint32_t)sim_budget) {
+            *cell = (uint8_t)rand();        // cut mid-program: undefined
+            sim_dead = true;
+            continue;
+        }
+        *cell = *p;
+        sim_programmed++;
+    }
+}
+
+uint8_t eeprom_free(void) {
+    return EEPROM_QUEUE_SIZE;
+}
+
+bool eeprom_busy(void) {
+    return false;
+}
+"""
+
+
+class KvInfo(ctypes.Structure):
+    _fields_ = [("generation", ctypes.c_uint16), ("capacity", ctypes.c_uint16),
+                ("used", ctypes.c_uint16), ("live", ctypes.c_uint16)]
+
+
+def build(cc, workdir):
+    for name, text in (("eeprom.h", EEPROM_SHIM), ("watchdog.h", WATCHDOG_SHIM),
+                       ("eeprom_sim.c", EEPROM_SIM)):
+        with open(os.path.join(workdir, name), "w") as f:
+            f.write(text)
+    lib = os.path.join(workdir, "kv.so")
+    subprocess.check_call([
+        cc, "-O2", "-shared", "-fPIC", "-iquote", workdir,
+        "-iquote", os.path.join(ROOT, "sys", "include"),
+        "-DKV_MAX_KEYS=%d" % KV_MAX_KEYS, "-DKV_VALUE_MAX=%d" % KV_VALUE_MAX,
+        os.path.join(ROOT, "sys", "src", "kv.c"), os.path.join(workdir, "eeprom_sim.c"),
+        "-o", lib,
+    ])
+    dll = ctypes.CDLL(lib)
+    dll.kv_init.restype = None
+    dll.kv_get.restype = ctypes.c_int16
+    dll.kv_get.argtypes = [ctypes.c_uint8, ctypes.c_void_p, ctypes.c_uint8]
+    dll.kv_set.restype = ctypes.c_bool
+    dll.kv_set.argtypes = [ctypes.c_uint8, ctypes.c_char_p, ctypes.c_uint8]
+    dll.kv_info.restype = None
+    dll.kv_info.argtypes = [ctypes.POINTER(KvInfo)]
+    dll.sim_power.restype = None
+    dll.sim_power.argtypes = [ctypes.c_int32, ctypes.c_uint]
+    return dll
+
+
+class Store:
+    def __init__(self, dll):
+        self.dll = dll
+        self.mem = (ctypes.c_uint8 * EEPROM_SIZE).in_dll(dll, "sim_eeprom")
+        self.programmed = ctypes.c_uint32.in_dll(dll, "sim_programmed")
+
+    def snapshot(self):
+        return bytes(self.mem)
+
+    def restore(self, data):
+        ctypes.memmove(self.mem, data, EEPROM_SIZE)
+
+    def boot(self, budget=-1, seed=0):
+        self.dll.sim_power(budget, seed)
+        self.dll.kv_init()
+
+    def get(self, key):
+        buf = ctypes.create_string_buffer(KV_VALUE_MAX)
+        n = self.dll.kv_get(key, buf, KV_VALUE_MAX)
+        return None if n < 0 else buf.raw[:n]
+
+    def contents(self):
+        return {k: v for k in range(KV_MAX_KEYS) for v in [self.get(k)] if v is not None}
+
+    def generation(self):
+        info = KvInfo()
+        self.dll.kv_info(ctypes.byref(info))
+        return info.generation
+
+
+def random_value(rng):
+    r = rng.random()
+    if r < 0.1:
+        return b""                              # delete
+    if r < 0.15:
+        return bytes(rng.randrange(256) for _ in range(KV_VALUE_MAX))
+    return bytes(rng.randrange(256) for _ in range(rng.randint(1, 8)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="KV store power-loss check on a simulated EEPROM")
+    parser.add_argument("--cc", default=os.environ.get("CC", "cc"), help="host C compiler")
+    parser.add_argument("--steps", type=int, default=5000, help="writes to cut")
+    parser.add_argument("--keys", type=int, default=12, help="keys in use (more fill the bank)")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    with tempfile.TemporaryDirectory() as workdir:
+        store = Store(build(args.cc, workdir))
+        for i in range(EEPROM_SIZE):
+            store.mem[i] = 0xFF
+        store.boot()
+
+        model = {}
+        cuts = compaction_cuts = new_kept = 0
+        for step in range(args.steps):
+            key = rng.randrange(args.keys)
+            value = random_value(rng)
+            before = store.snapshot()
+            gen = store.generation()
+
+            # full run: bytes programmed, and whether the store accepts it
+            store.boot()
+            ok = store.dll.kv_set(key, value, len(value))
+            programmed = store.programmed.value
+            compacted = store.generation() != gen
+            after = store.snapshot()
+
+            if programmed:
+                # same write from the same contents, power cut at a random byte
+                store.restore(before)
+                store.boot(rng.randrange(programmed), rng.randrange(1 << 31))
+                store.dll.kv_set(key, value, len(value))
+                store.boot()
+                cuts += 1
+                compaction_cuts += compacted
+
+                got = store.contents()
+                old = model.get(key)
+                new = value if value else None
+                others = {k: v for k, v in got.items() if k != key}
+                expected = {k: v for k, v in model.items() if k != key}
+                if got.get(key) not in (old, new) or others != expected:
+                    print("step %d: key %d, old %r, new %r (compaction %s): lost or corrupted"
+                          % (step, key, old, new, compacted))
+                    for k in sorted(set(got) | set(model)):
+                        if got.get(k) != model.get(k):
+                            print("  key %d: %r, expected %r" % (k, got.get(k), model.get(k)))
+                    return 1
+                new_kept += (old != new and got.get(key) == new)
+
+            # carry on from the uninterrupted write
+            store.restore(after)
+            store.boot()
+            if ok:
+                if value:
+                    model[key] = value
+                else:
+                    model.pop(key, None)
+            if store.contents() != model:
+                print("step %d: store differs from the model after a clean write" % step)
+                return 1
+
+        print("%d writes cut, %d during compaction, %d kept the new value; generation %d"
+              % (cuts, compaction_cuts, new_kept, store.generation()))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
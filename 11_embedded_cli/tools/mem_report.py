@@ -0,0 +1,204 @@
+#!/usr/bin/env python3
+"""
+mem_report.py
+
+Prints flash/SRAM/EEPROM usage of a linked image from the GNU ld map file
+(-Wl,-Map=...), per memory region, per output section and per module
+(object file or library member), so memory budgets can be compared from
+one commit to the next.
+
+Regions come from the "Memory Configuration" table of the map. Sections
+that are loaded from flash but live in SRAM (.data, which also carries
+.rodata) count against both.
+
+Usage:
+    python3 tools/mem_report.py build/11_embedded_cli.map
+    python3 tools/mem_report.py build/11_embedded_cli.map --flash-budget 16384 --sram-budget 1536
+
+Exits non-zero if a budget is given and exceeded.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+SECTION_RE = re.compile(r"^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+load address 0x([0-9a-fA-F]+))?")
+SECTION_NAME_RE = re.compile(r"^(\.\S+)\s*$")
+INPUT_RE = re.compile(r"^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+INPUT_NAME_RE = re.compile(r"^ (\S+)\s*$")
+INPUT_CONT_RE = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+REGION_RE = re.compile(r"^(\w+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+
+# The map does not mark NOLOAD sections; ld still prints a load address for
+# them, but nothing is stored there
+NOLOAD_SECTIONS = (".bss", ".noinit")
+
+
+def parse_map(path):
+    regions = []          # (name, origin, length)
+    sections = []         # dicts: name, vma, size, lma
+    current = None
+    pending_section = None
+    pending_input = None
+    state = None
+
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\r\n")
+
+            if line.startswith("Memory Configuration"):
+                state = "memory"
+                continue
+            if line.startswith("Linker script and memory map"):
+                state = "map"
+                continue
+
+            if state == "memory":
+                m = REGION_RE.match(line)
+                if m and m.group(1) != "Name":
+                    regions.append((m.group(1), int(m.group(2), 16), int(m.group(3), 16)))
+                continue
+            if state != "map":
+                continue
+
+            # output section, possibly with its numbers on the next line
+            if pending_section is not None:
+                m = re.match(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+load address 0x([0-9a-fA-F]+))?", line)
+                if m:
+                    current = new_section(pending_section, m.group(1), m.group(2), m.group(3))
+                    sections.append(current)
+                pending_section = None
+                continue
+            if not line.startswith(" "):
+                m = SECTION_RE.match(line)
+                if m and m.group(1).startswith("."):
+                    current = new_section(m.group(1), m.group(2), m.group(3), m.group(4))
+                    sections.append(current)
+                    continue
+                m = SECTION_NAME_RE.match(line)
+                if m:
+                    pending_section = m.group(1)
+                    continue
+                current = None if line.startswith("OUTPUT(") else current
+                continue
+
+            if current is None:
+                continue
+
+            # input section, possibly with its numbers on the next line
+            if pending_input is not None:
+                m = INPUT_CONT_RE.match(line)
+                if m:
+                    add_input(current, int(m.group(2), 16), m.group(3))
+                pending_input = None
+                continue
+            m = INPUT_RE.match(line)
+            if m:
+                if m.group(1) == "*fill*":
+                    add_input(current, int(m.group(3), 16), "(fill)")
+                elif not m.group(1).startswith("*"):
+                    add_input(current, int(m.group(3), 16), m.group(4))
+                continue
+            m = INPUT_NAME_RE.match(line)
+            if m and not m.group(1).startswith("*"):
+                pending_input = m.group(1)
+
+    return regions, sections
+
+
+def new_section(name, vma, size, lma):
+    vma = int(vma, 16)
+    return {"name": name, "vma": vma, "size": int(size, 16),
+            "lma": int(lma, 16) if lma else vma, "modules": {}}
+
+
+def add_input(section, size, module):
+    if size == 0:
+        return
+    module = module.strip()
+    # "/path/libm.a(mulsf3.o)" -> "libm.a(mulsf3.o)", objects relative to the build
+    m = re.match(r"^(.*?)([^/\\]+\.a)\((.+)\)$", module)
+    if m:
+        module = "%s(%s)" % (m.group(2), m.group(3))
+    else:
+        module = os.path.relpath(module) if os.path.isabs(module) else module
+    section["modules"][module] = section["modules"].get(module, 0) + size
+
+
+def region_of(regions, address):
+    for name, origin, length in regions:
+        if name != "*default*" and origin <= address < origin + length:
+            return name
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Report memory usage from a GNU ld map file")
+    parser.add_argument("map", help="map file written by -Wl,-Map=")
+    parser.add_argument("--flash-budget", type=int, help="fail if flash use exceeds this many bytes")
+    parser.add_argument("--sram-budget", type=int, help="fail if static SRAM use exceeds this many bytes")
+    args = parser.parse_args()
+
+    regions, sections = parse_map(args.map)
+    if not regions:
+        print("%s: no Memory Configuration table found" % args.map)
+        return 1
+
+    used = {name: 0 for name, _, _ in regions}
+    modules = {}
+    rows = []
+
+    for s in sections:
+        if s["size"] == 0:
+            continue
+        vma_region = region_of(regions, s["vma"])
+        lma_region = region_of(regions, s["lma"])
+        if s["name"].startswith(NOLOAD_SECTIONS):
+            lma_region = vma_region
+        if vma_region is None:
+            continue                    # debug info and other non-loaded sections
+        charged = [vma_region]
+        if lma_region and lma_region != vma_region:
+            charged.append(lma_region)  # initialised data: image in flash, copy in SRAM
+
+        for region in charged:
+            used[region] += s["size"]
+        rows.append((s["name"], "/".join(charged), s["size"]))
+
+        for module, size in s["modules"].items():
+            totals = modules.setdefault(module, {})
+            for region in charged:
+                totals[region] = totals.get(region, 0) + size
+
+    names = [name for name, _, _ in regions if name != "*default*"]
+
+    print("Memory usage: %s" % args.map)
+    print()
+    print("  %-8s %8s %8s %7s" % ("Region", "Used", "Size", "Use%"))
+    for name, origin, length in regions:
+        if name == "*default*":
+            continue
+        print("  %-8s %8d %8d %6.1f%%" % (name, used[name], length, 100.0 * used[name] / length))
+
+    print()
+    print("  %-16s %-12s %8s" % ("Section", "Region", "Size"))
+    for name, region, size in rows:
+        print("  %-16s %-12s %8d" % (name, region, size))
+
+    print()
+    print("  %-36s" % "Module" + "".join(" %8s" % n for n in names))
+    order = sorted(modules.items(), key=lambda kv: -sum(kv[1].values()))
+    for module, totals in order:
+        print("  %-36s" % module[-36:] + "".join(" %8d" % totals.get(n, 0) for n in names))
+
+    failed = False
+    for region, budget in (("FLASH", args.flash_budget), ("SRAM", args.sram_budget)):
+        if budget is not None and used.get(region, 0) > budget:
+            print("%s: %d bytes used, budget is %d" % (region, used[region], budget))
+            failed = True
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())